@@ -0,0 +1,514 @@
+// Microbenchmarks for the engine hot paths
+// Every benchmark reports the time and the number of heap allocations per operation and the throughput,
+// the results are written as JSON so they can be compared release over release
+// Run from the build directory so the meshes in data/ are found
+// Usage: treasuregunner_bench [--filter SUBSTRING] [--min-time MS] [--out FILE]
+
+// The simulation still references the GL entry points (gl_has_errors), they are never called
+#define GL3W_IMPLEMENTATION
+#include <gl3w.h>
+
+// stlib
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+// internal
+#include "ai_system.hpp"
+#include "alloc_tracker.hpp"
+#include "bullet_system.hpp"
+#include "collisions.hpp"
+#include "gun_table.hpp"
+#include "particles.hpp"
+#include "prefabs.hpp"
+#include "projectile_pool.hpp"
+#include "render_system.hpp"
+#include "room_generation.hpp"
+#include "spline_arena.hpp"
+#include "tiny_ecs_registry.hpp"
+#include "world_init.hpp"
+using Clock = std::chrono::high_resolution_clock;
+
+// A benchmark runs `run` repeatedly, every call performs `ops` operations
+// `reset` is called before every run to restore the input and is not measured
+struct Benchmark {
+	std::string name;
+	int ops;
+	std::function<void()> reset;
+	std::function<void()> run;
+};
+
+struct BenchmarkResult {
+	std::string name;
+	long long iterations;
+	long long ops;
+	double ns_per_op;
+	double allocs_per_op;
+	double ops_per_second;
+};
+
+static BenchmarkResult measure(const Benchmark& benchmark, double min_time_ms)
+{
+	const int warmup_iterations = 2;
+	const int min_iterations = 5;
+	for (int i = 0; i < warmup_iterations; i++) {
+		if (benchmark.reset) benchmark.reset();
+		benchmark.run();
+	}
+
+	double elapsed_ns = 0;
+	long long allocations = 0;
+	long long iterations = 0;
+	while (iterations < min_iterations || elapsed_ns < min_time_ms * 1e6) {
+		if (benchmark.reset) benchmark.reset();
+		long long allocations_before = alloc_stats().count;
+		auto start = Clock::now();
+		benchmark.run();
+		auto end = Clock::now();
+		allocations += alloc_stats().count - allocations_before;
+		elapsed_ns += std::chrono::duration<double, std::nano>(end - start).count();
+		iterations++;
+	}
+
+	BenchmarkResult result;
+	result.name = benchmark.name;
+	result.iterations = iterations;
+	result.ops = iterations * benchmark.ops;
+	result.ns_per_op = elapsed_ns / result.ops;
+	result.allocs_per_op = (double)allocations / result.ops;
+	result.ops_per_second = result.ops / (elapsed_ns / 1e9);
+	return result;
+}
+
+// Keeps the optimizer from dropping the results of the benchmarked code
+static volatile float sink;
+
+const int ecs_count = 1000;
+const float elapsed_ms = 1000.f / 60.f;
+
+// The colliders used by the player, enemies and the boss
+const char* collider_paths[] = {
+	"BombMesh.obj",
+	"BossCollider-Triangulated.obj",
+	"CharacterCollider-scaled.obj",
+	"DummyCollider-Rotated.obj",
+	"EnemyElite.obj",
+	"EnemyNeutral-Scaled.obj",
+	"FlamethrowerMesh.obj",
+	"ZapperMesh.obj",
+};
+const int collider_count = sizeof(collider_paths) / sizeof(collider_paths[0]);
+
+static void add_ecs_benchmarks(std::vector<Benchmark>& benchmarks)
+{
+	// Shared between the benchmarks, entity ids are never reused so they are created once
+	static ComponentContainer<Motion> container;
+	static std::vector<Entity> entities(ecs_count);
+	static std::vector<Entity> shuffled;
+	shuffled = entities;
+	std::shuffle(shuffled.begin(), shuffled.end(), std::default_random_engine(427));
+
+	auto fill = [](const std::vector<Entity>& order) {
+		container.clear();
+		for (Entity entity : order)
+			container.emplace(entity).position = { (float)(unsigned int)entity, 0.f };
+	};
+
+	benchmarks.push_back({ "ecs_insert", ecs_count,
+		[]() { container.clear(); },
+		[fill]() { fill(entities); } });
+
+	benchmarks.push_back({ "ecs_get", ecs_count,
+		[fill]() { if (container.size() != ecs_count) fill(entities); },
+		[]() {
+			float sum = 0;
+			for (Entity entity : shuffled)
+				sum += container.get(entity).position.x;
+			sink = sum;
+		} });
+
+	benchmarks.push_back({ "ecs_remove", ecs_count,
+		[fill]() { fill(entities); },
+		[]() {
+			for (Entity entity : shuffled)
+				container.remove(entity);
+		} });
+
+	benchmarks.push_back({ "ecs_clear_scope", ecs_count,
+		[fill]() { fill(entities); },
+		[]() { container.clear_scope(ENTITY_SCOPE::ROOM); } });
+
+	benchmarks.push_back({ "ecs_sort", ecs_count,
+		[fill]() { fill(shuffled); },
+		[]() { container.sort([](Entity a, Entity b) { return (unsigned int)a < (unsigned int)b; }); } });
+}
+
+// One entity per shipped collider, overlapping in the middle of the screen
+static std::vector<Entity> create_colliders()
+{
+	std::vector<Entity> colliders;
+	for (int i = 0; i < collider_count; i++) {
+		Entity entity;
+		Motion& motion = registry.motions.emplace(entity);
+		motion.position = { window_width_px / 2.f + i * 10.f, window_height_px / 2.f };
+		motion.scale = { 120.f, 120.f };
+		registry.collisionMeshes.insert(entity, createMeshCollider(entity, collider_paths[i]));
+		colliders.push_back(entity);
+	}
+	return colliders;
+}
+
+// Moves the colliders a little so their collision cache entries are refreshed like in a real frame
+static void move_colliders(const std::vector<Entity>& colliders)
+{
+	for (Entity entity : colliders) {
+		Motion& motion = registry.motions.get(entity);
+		motion.angle += 0.01f;
+		motion.position.x += motion.position.x > window_width_px / 2.f + 100.f ? -100.f : 1.f;
+	}
+}
+
+static void add_collision_benchmarks(std::vector<Benchmark>& benchmarks)
+{
+	static std::vector<Entity> colliders;
+	const int pair_count = collider_count * (collider_count - 1) / 2;
+
+	auto setup = []() {
+		registry.clear_all_components();
+		colliders = create_colliders();
+	};
+
+	using CollisionTest = bool(*)(Entity, Entity, float&, vec2&);
+	auto add = [&](const char* name, CollisionTest test) {
+		benchmarks.push_back({ name, pair_count,
+			[setup]() {
+				if (colliders.empty() || !registry.motions.has(colliders[0]))
+					setup();
+				move_colliders(colliders);
+			},
+			[test]() {
+				float overlap;
+				vec2 normal;
+				int hits = 0;
+				for (int i = 0; i < collider_count; i++)
+					for (int j = i + 1; j < collider_count; j++)
+						hits += test(colliders[i], colliders[j], overlap, normal);
+				sink = (float)hits;
+			} });
+	};
+	add("collides_AABB", collides_AABB);
+	add("collides_SAT", collides_SAT);
+
+	// The OBJ files are cached after the first load, this measures building the scaled collider
+	benchmarks.push_back({ "create_mesh_collider", collider_count,
+		[setup]() {
+			if (colliders.empty() || !registry.motions.has(colliders[0]))
+				setup();
+		},
+		[]() {
+			size_t vertices = 0;
+			for (int i = 0; i < collider_count; i++)
+				vertices += createMeshCollider(colliders[i], collider_paths[i]).vertices.size();
+			sink = (float)vertices;
+		} });
+}
+
+// A single flock spread over an area that grows with the flock so the number of neighbours per boid stays roughly constant
+static void create_flock(int boid_count)
+{
+	registry.clear_all_components();
+	std::default_random_engine rng(427);
+	std::uniform_real_distribution<float> uniform_dist(0.f, 1.f);
+
+	// Keep the density of a normal swarm (about 100 boids on screen)
+	float area_scale = std::sqrt(boid_count / 100.f);
+	vec2 area = vec2(window_width_px, window_height_px) * area_scale;
+
+	Entity target;
+	Motion& target_motion = registry.motions.emplace(target);
+	target_motion.position = area / 2.f;
+
+	Entity flock;
+	Flock& flock_component = registry.flocks.emplace(flock);
+	flock_component.target = target;
+	for (int i = 0; i < boid_count; i++) {
+		Entity boid;
+		Motion& motion = registry.motions.emplace(boid);
+		motion.position = { uniform_dist(rng) * area.x, uniform_dist(rng) * area.y };
+		motion.velocity = { uniform_dist(rng) * 200.f - 100.f, uniform_dist(rng) * 200.f - 100.f };
+		addToFlock(flock, boid);
+	}
+}
+
+static void add_boid_benchmarks(std::vector<Benchmark>& benchmarks)
+{
+	static AISystem ai_system;
+	const int boid_counts[] = { 100, 1000, 10000 };
+	for (int boid_count : boid_counts) {
+		benchmarks.push_back({ "boids_" + std::to_string(boid_count), boid_count,
+			[boid_count]() {
+				if (registry.flocks.size() != 1 || registry.flocks.components[0].boids.size() != (size_t)boid_count)
+					create_flock(boid_count);
+			},
+			[]() { ai_system.step(elapsed_ms); } });
+	}
+}
+
+static void add_particle_benchmarks(std::vector<Benchmark>& benchmarks)
+{
+	const int system_count = 100;
+	const int particles_per_system = 20;
+	const TEXTURE_ASSET_ID textures[] = {
+		TEXTURE_ASSET_ID::SPARK_BASE,
+		TEXTURE_ASSET_ID::DEATH,
+		TEXTURE_ASSET_ID::HEART_PARTICLE,
+		TEXTURE_ASSET_ID::BULLET_DEAD_BASE,
+	};
+	static Entity player;
+	static ScreenState screen;
+
+	benchmarks.push_back({ "particles", system_count * particles_per_system,
+		[=]() {
+			if (registry.particleSystems.size() == system_count)
+				return;
+			registry.clear_all_components();
+			registry.motions.emplace(player).position = { window_width_px / 2.f, window_height_px / 2.f };
+			for (int i = 0; i < system_count; i++) {
+				vec2 position = { (float)(i * 37 % window_width_px), (float)(i * 53 % window_height_px) };
+				// Long lived so the systems are not removed while measuring
+				createParticleSystem(position, { 100.f, -50.f }, particles_per_system, 1e9f, 0.f, 10, textures[i % 4]);
+			}
+		},
+		[]() { stepParticleSystems(elapsed_ms, player, screen); } });
+}
+
+// One OMNI_SHOT volley worth of bullets per batch, spawned with their collision cache entry and destroyed again
+static void add_projectile_benchmarks(std::vector<Benchmark>& benchmarks)
+{
+	const int bullet_count = 100;
+	static std::vector<Entity> bullets;
+	static std::vector<Entity> spline_bullets;
+
+	benchmarks.push_back({ "projectile_spawn_despawn", bullet_count,
+		[]() {
+			if (!bullets.empty())
+				return;
+			registry.clear_all_components();
+			projectilePool.reserve(512);
+			bullets.resize(bullet_count);
+		},
+		[]() {
+			for (int i = 0; i < bullet_count; i++) {
+				bullets[i] = createBullet({ 100.f + i, 200.f }, i * 0.0628f, 500.f, false, 1000.f, false, false, 7.f, 1.f, GUN_ID::OMNI_SHOT);
+				insertCollisionCache(bullets[i]);
+			}
+			for (int i = 0; i < bullet_count; i++)
+				registry.remove_all_components_of(bullets[i]);
+		} });
+
+	// The collision pass over a screen full of bullets, every bullet refreshes its cached collider and checks its hit list
+	const int flying_count = 1000;
+	static std::vector<Entity> flying;
+	benchmarks.push_back({ "projectile_collider_refresh", flying_count,
+		[]() {
+			if (!flying.empty() && registry.projectiles.has(flying[0]))
+				return;
+			registry.clear_all_components();
+			flying.clear();
+			for (int i = 0; i < flying_count; i++) {
+				Entity bullet = createBullet({ 100.f + i % 1600, 100.f + i / 2 }, i * 0.0628f, 500.f, true, 1000.f, true, true, 7.f, 1.f, GUN_ID::BOUNCING_SHOT);
+				insertCollisionCache(bullet);
+				registry.projectiles.get(bullet).hit_entities.push_back(Entity());
+				flying.push_back(bullet);
+			}
+		},
+		[]() {
+			int hits = 0;
+			for (int i = 0; i < (int)registry.projectiles.size(); i++) {
+				Entity bullet = registry.projectiles.entities[i];
+				registry.motions.get(bullet).angle += 0.01f;
+				updateCollisionCache(bullet);
+				for (Entity hit : registry.projectiles.components[i].hit_entities)
+					hits += (unsigned int)hit == (unsigned int)bullet;
+			}
+			sink = (float)hits;
+		} });
+
+	// Split spline volleys, every bullet samples its own curve into the spline arena
+	benchmarks.push_back({ "spline_bullet_spawn_despawn", bullet_count,
+		[]() {
+			if (!spline_bullets.empty())
+				return;
+			registry.clear_all_components();
+			projectilePool.reserve(512);
+			splineArena.reserve(512);
+			spline_bullets.resize(bullet_count);
+		},
+		[]() {
+			vec2 target = { window_width_px / 2.f, window_height_px / 2.f };
+			for (int i = 0; i < bullet_count; i++) {
+				spline_bullets[i] = createSplineBullet({ 100.f + i, 200.f }, target, i * 0.0628f, 800.f, false, 800.f, false, false, 5.f);
+				insertCollisionCache(spline_bullets[i]);
+			}
+			for (int i = 0; i < bullet_count; i++)
+				registry.remove_all_components_of(spline_bullets[i]);
+		} });
+}
+
+// A boss pattern worth of enemy bullets flying through a walled room around the player
+static void add_bullet_benchmarks(std::vector<Benchmark>& benchmarks)
+{
+	const int bullet_count = 4096;
+	static RenderSystem renderer;
+
+	benchmarks.push_back({ "enemy_bullets_step", bullet_count,
+		[=]() {
+			if (registry.players.size() == 0 || registry.walls.size() == 0) {
+				registry.clear_all_components();
+				createBoundaryWalls(&renderer);
+				createPlayer(&renderer, { window_width_px / 2.f, window_height_px / 2.f });
+				bulletSystem.reserve(bullet_count);
+			}
+			// Rings of bullets spread over the room, out of range of each other's walls for one step
+			bulletSystem.clear();
+			for (int i = 0; i < bullet_count; i++) {
+				float angle = i * 0.0123f;
+				vec2 position = { 200.f + (i * 37 % 1520), 150.f + (i * 53 % 780) };
+				bulletSystem.spawn(position, angle, 500.f, 1000.f, 7.f, (BULLET_STYLE)(i % bullet_style_count));
+			}
+		},
+		[]() { bulletSystem.step(elapsed_ms); } });
+}
+
+// A room's worth of enemies spawned in one frame, the way a mega swarm or a boss summon fills the room
+static void add_spawn_benchmarks(std::vector<Benchmark>& benchmarks)
+{
+	const int swarm_count = 32;
+	static RenderSystem renderer;
+
+	benchmarks.push_back({ "swarm_spawn", swarm_count * 2,
+		[]() { registry.clear_all_components(); },
+		[]() {
+			Entity target;
+			vec2 spawn_min = { 200.f, 150.f };
+			vec2 spawn_max = { window_width_px - 200.f, window_height_px - 150.f };
+			createSwarm(&renderer, target, spawn_min, spawn_max, swarm_count, swarm_count / 4, false);
+			createZapperSwarm(&renderer, target, spawn_min, spawn_max, swarm_count / 2, false);
+			createFlameThrowerSwarm(&renderer, target, spawn_min, spawn_max, swarm_count / 2, true);
+		} });
+
+	// Leaving the room drops the same enemies, their flocks and the floor and walls of the room
+	benchmarks.push_back({ "room_teardown", swarm_count * 2,
+		[]() {
+			registry.clear_all_components();
+			Entity target;
+			vec2 spawn_min = { 200.f, 150.f };
+			vec2 spawn_max = { window_width_px - 200.f, window_height_px - 150.f };
+			createFloor(&renderer, { window_width_px / 2, window_height_px / 2 }, window_width_px, window_height_px);
+			createBoundaryWalls(&renderer);
+			createSwarm(&renderer, target, spawn_min, spawn_max, swarm_count, swarm_count / 4, false);
+			createZapperSwarm(&renderer, target, spawn_min, spawn_max, swarm_count / 2, false);
+			createFlameThrowerSwarm(&renderer, target, spawn_min, spawn_max, swarm_count / 2, true);
+		},
+		[]() { registry.clear_scope(ENTITY_SCOPE::ROOM); } });
+}
+
+static void add_mesh_benchmarks(std::vector<Benchmark>& benchmarks)
+{
+	benchmarks.push_back({ "load_obj", collider_count,
+		nullptr,
+		[]() {
+			size_t vertices = 0;
+			for (int i = 0; i < collider_count; i++) {
+				std::vector<ColoredVertex> out_vertices;
+				std::vector<uint16_t> out_vertex_indices;
+				vec2 out_size;
+				Mesh::loadFromOBJFile(mesh_path(collider_paths[i]), out_vertices, out_vertex_indices, out_size);
+				vertices += out_vertices.size();
+			}
+			sink = (float)vertices;
+		} });
+}
+
+static void write_json(FILE* file, const std::vector<BenchmarkResult>& results, double min_time_ms)
+{
+	fprintf(file, "{\n");
+	fprintf(file, "  \"min_time_ms\": %.1f,\n", min_time_ms);
+	fprintf(file, "  \"benchmarks\": [\n");
+	for (size_t i = 0; i < results.size(); i++) {
+		const BenchmarkResult& result = results[i];
+		fprintf(file, "    {\"name\": \"%s\", \"iterations\": %lld, \"ops\": %lld, \"ns_per_op\": %.3f, \"allocs_per_op\": %.4f, \"ops_per_second\": %.1f}%s\n",
+			result.name.c_str(), result.iterations, result.ops, result.ns_per_op, result.allocs_per_op, result.ops_per_second,
+			i + 1 < results.size() ? "," : "");
+	}
+	fprintf(file, "  ]\n");
+	fprintf(file, "}\n");
+}
+
+int main(int argc, char* argv[])
+{
+	std::string filter;
+	std::string out_path = "bench_results.json";
+	double min_time_ms = 200.0;
+	for (int i = 1; i < argc; i++) {
+		bool has_value = i + 1 < argc;
+		if (strcmp(argv[i], "--filter") == 0 && has_value) {
+			filter = argv[++i];
+		}
+		else if (strcmp(argv[i], "--min-time") == 0 && has_value) {
+			min_time_ms = atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--out") == 0 && has_value) {
+			out_path = argv[++i];
+		}
+		else {
+			printf("Usage: %s [--filter SUBSTRING] [--min-time MS] [--out FILE]\n", argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	// Enemies are spawned from the prefabs, which are built with the guns of the gun table
+	if (!gunTable.load(data_path() + "/guns.txt"))
+		return EXIT_FAILURE;
+	static RenderSystem renderer;
+	prefabTable.init(&renderer);
+
+	std::vector<Benchmark> benchmarks;
+	add_ecs_benchmarks(benchmarks);
+	add_collision_benchmarks(benchmarks);
+	add_boid_benchmarks(benchmarks);
+	add_particle_benchmarks(benchmarks);
+	add_projectile_benchmarks(benchmarks);
+	add_bullet_benchmarks(benchmarks);
+	add_spawn_benchmarks(benchmarks);
+	add_mesh_benchmarks(benchmarks);
+
+	std::vector<BenchmarkResult> results;
+	for (const Benchmark& benchmark : benchmarks) {
+		if (benchmark.name.find(filter) == std::string::npos)
+			continue;
+		results.push_back(measure(benchmark, min_time_ms));
+	}
+
+	FILE* file = fopen(out_path.c_str(), "w");
+	if (file == NULL) {
+		printf("Can't write the results to %s\n", out_path.c_str());
+		return EXIT_FAILURE;
+	}
+	write_json(file, results, min_time_ms);
+	fclose(file);
+
+	// The OBJ loader logs every file it opens, the summary comes last so it is not interleaved
+	printf("\n%-24s %14s %14s %16s\n", "benchmark", "ns/op", "allocs/op", "ops/s");
+	for (const BenchmarkResult& result : results)
+		printf("%-24s %14.2f %14.4f %16.0f\n", result.name.c_str(), result.ns_per_op, result.allocs_per_op, result.ops_per_second);
+	printf("Results written to %s\n", out_path.c_str());
+	return EXIT_SUCCESS;
+}
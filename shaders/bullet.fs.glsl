@@ -0,0 +1,33 @@
+#version 330 core
+
+// From vertex shader
+flat in float angle;
+
+// Application data
+uniform sampler2D base;
+uniform sampler2D samplerGlow;
+
+layout(location = 0) out vec4 fragColor;
+layout(location = 1) out vec4 emissive;
+
+// The point is the bounding square of the rotated sprite, its side is sqrt(2) times the sprite's
+const float point_to_sprite = 1.41421356;
+
+void main() {
+    // Undo the rotation of the bullet to get the texture coordinates of the sprite quad
+    vec2 coords = (gl_PointCoord - 0.5) * point_to_sprite;
+    float s = sin(angle);
+    float c = cos(angle);
+    vec2 texcoord = vec2(c * coords.x + s * coords.y, -s * coords.x + c * coords.y) + 0.5;
+    if (texcoord.x < 0.0 || texcoord.x > 1.0 || texcoord.y < 0.0 || texcoord.y > 1.0) {
+        discard;
+    }
+
+    vec4 mainColor = texture(base, texcoord);
+    if (mainColor.a == 0) {
+        discard;
+    } else {
+        fragColor = mainColor;
+        emissive = texture(samplerGlow, texcoord);
+    }
+}
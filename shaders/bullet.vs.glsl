@@ -0,0 +1,19 @@
+#version 330
+
+// Input attributes
+layout(location = 0) in vec2 in_position;
+layout(location = 1) in float in_angle;
+
+// Passed to fragment shader
+flat out float angle;
+
+// Application data
+uniform mat3 projection;
+uniform float pointSize;
+
+void main() {
+	angle = in_angle;
+	vec3 pos = projection * vec3(in_position, 1.0);
+	gl_Position = vec4(pos.xy, 0.0, 1.0);
+	gl_PointSize = pointSize;
+}
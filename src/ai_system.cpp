@@ -1,10 +1,19 @@
 // internal
 #include "ai_system.hpp"
+#include "profiler.hpp"
 
 void AISystem::step(float elapsed_ms)
 {
+	PROFILE_SCOPE("AISystem::step");
 	(void)elapsed_ms; // placeholder to silence unused warning until implemented
 	auto& boid_container = registry.flock;
+	updatedAgents = 0;
+	totalAgents = 0;
+	if (registry.players.size() > 0) {
+		PROFILE_SCOPE("FlowField::update");
+		flowField.update(registry.motions.get(registry.players.entities[0]).position);
+	}
+	scheduleAgents();
 	for (int i = 0; i < registry.flocks.components.size(); i++) {
 		updateBoids(registry.flocks.entities[i], elapsed_ms);
 	}
@@ -24,100 +33,242 @@ vec2 normalized(vec2 in) {
 	return vec2(in.x / mag, in.y / mag);
 }
 
-void AISystem::updateBoids(Entity flock, float elapsed_ms) {
-	auto& boids = registry.flocks.get(flock).boids;
-	// Remove boids that have been destroyed
-	for (int i = 0; i < boids.size(); i++) {
-		while (!registry.motions.has(boids[i])) {
-			boids.erase(boids.begin() + i);
-			if (i >= boids.size()) break;
+void AISystem::scheduleAgents() {
+	PROFILE_SCOPE("AISystem::scheduleAgents");
+	// Pick the agents of every flock that are due to steer this frame
+	dueAgents.clear();
+	for (uint i = 0; i < registry.flocks.components.size(); i++) {
+		const Flock& flock = registry.flocks.components[i];
+		if (flock.boids.size() == 0) continue;
+		vec2 target_position = registry.motions.get(flock.target).position;
+		for (Entity boid : flock.boids) {
+			if (!registry.aiSchedules.has(boid)) {
+				// Stagger new agents so that agents ticking at the same rate do not all update on the same frame
+				AiSchedule& schedule = registry.aiSchedules.emplace(boid);
+				schedule.frames_since_update = (unsigned int)boid % lodFarInterval;
+			}
+			AiSchedule& schedule = registry.aiSchedules.get(boid);
+			schedule.frames_since_update++;
+			schedule.interval = updateInterval(calculateDistance(registry.motions.get(boid).position, target_position));
+			schedule.steps = 0;
+			if (schedule.frames_since_update >= schedule.interval) {
+				dueAgents.push_back(boid);
+			}
 		}
 	}
+
+	// Spend the budget on the most overdue agents over all flocks
+	if (maxAgentUpdatesPerFrame > 0 && (int)dueAgents.size() > maxAgentUpdatesPerFrame) {
+		std::stable_sort(dueAgents.begin(), dueAgents.end(), [](Entity a, Entity b) {
+			return registry.aiSchedules.get(a).frames_since_update > registry.aiSchedules.get(b).frames_since_update;
+		});
+		dueAgents.resize(maxAgentUpdatesPerFrame);
+	}
+
+	for (Entity agent : dueAgents) {
+		AiSchedule& schedule = registry.aiSchedules.get(agent);
+		schedule.steps = min(schedule.frames_since_update, maxCatchUpFrames);
+		schedule.frames_since_update = 0;
+	}
+	updatedAgents = (int)dueAgents.size();
+}
+
+void AISystem::updateBoids(Entity flock, float elapsed_ms) {
+	PROFILE_SCOPE("AISystem::updateBoids");
+	// Destroyed boids have already left the flock, see remove_flock_member
+	auto& boids = registry.flocks.get(flock).boids;
 	// Remove flock if there are no boids left
 	if (boids.size() == 0) {
 		registry.flocks.remove(flock);
 		return;
 	}
 
-	for (int i = 0; i < boids.size(); i++) {
-		updateBoid(boids[i], boids, registry.flocks.get(flock).target, elapsed_ms);
+	// Snapshot the flock
+	int count = (int)boids.size();
+	positions.resize(count);
+	velocities.resize(count);
+	newVelocities.resize(count);
+	for (int i = 0; i < count; i++) {
+		Motion& motion = registry.motions.get(boids[i]);
+		positions[i] = motion.position;
+		velocities[i] = motion.velocity;
+	}
+	buildGrid();
+
+	Entity target = registry.flocks.get(flock).target;
+	vec2 target_position = registry.motions.get(target).position;
+	bool follow_flow_field = registry.players.has(target);
+
+	// Gather the boids that scheduleAgents picked for this frame
+	dueBoids.clear();
+	dueSteps.clear();
+	for (int i = 0; i < count; i++) {
+		const AiSchedule& schedule = registry.aiSchedules.get(boids[i]);
+		if (schedule.steps > 0) {
+			dueBoids.push_back(i);
+			dueSteps.push_back(schedule.steps);
+		}
+	}
+	int due_count = (int)dueBoids.size();
+	totalAgents += count;
+
+	// Steer the due boids using only the snapshot
+	{
+		PROFILE_SCOPE("steer boids");
+		workers.parallel_for(due_count, boidsPerTask, [this, target_position, follow_flow_field](int begin, int end) {
+			for (int i = begin; i < end; i++) {
+				newVelocities[dueBoids[i]] = steerBoid(dueBoids[i], target_position, follow_flow_field, (float)dueSteps[i]);
+			}
+		});
+	}
+
+	// Write the results back
+	for (int i = 0; i < due_count; i++) {
+		registry.motions.get(boids[dueBoids[i]]).velocity = newVelocities[dueBoids[i]];
 	}
+
+	// Facing is cheap and is kept up to date every frame
+	for (int i = 0; i < count; i++) {
+		Motion& boidMotion = registry.motions.get(boids[i]);
+
+		if (registry.rotates.has(boids[i])) {
+			// Apply spinning motion separately
+			float spinSpeed = 0.0005f; // Set the speed of rotation in radians per millisecond
+			float angleChange = spinSpeed * elapsed_ms; // Calculate the angle change in radians
+
+			// Update the angle of the entity to simulate spinning in place
+			if (registry.rotates.get(boids[i]).direction) {
+				boidMotion.angle += angleChange;
+			}
+			else {
+				boidMotion.angle -= angleChange;
+			}
+		}
+		else {
+			boidMotion.angle = std::atan2(target_position.y - boidMotion.position.y, target_position.x - boidMotion.position.x);
+		}
+	}
+}
+
+int AISystem::updateInterval(float distance) const {
+	if (!lodEnabled || distance < lodNearDistance) return 1;
+	if (distance < lodFarDistance) return lodMidInterval;
+	return lodFarInterval;
+}
+
+void AISystem::buildGrid() {
+	int count = (int)positions.size();
+	vec2 min_position = positions[0];
+	vec2 max_position = positions[0];
+	for (int i = 1; i < count; i++) {
+		min_position = min(min_position, positions[i]);
+		max_position = max(max_position, positions[i]);
+	}
+	grid.origin = min_position;
+	grid.columns = (int)((max_position.x - min_position.x) / visualRadius) + 1;
+	grid.rows = (int)((max_position.y - min_position.y) / visualRadius) + 1;
+
+	// Counting sort of the boids by cell
+	grid.cell_start.assign(grid.columns * grid.rows + 1, 0);
+	grid.boid_cell.resize(count);
+	grid.boid_order.resize(count);
+	for (int i = 0; i < count; i++) {
+		vec2 local = (positions[i] - grid.origin) / visualRadius;
+		int cell = (int)local.y * grid.columns + (int)local.x;
+		grid.boid_cell[i] = cell;
+		grid.cell_start[cell + 1]++;
+	}
+	for (int cell = 0; cell < grid.columns * grid.rows; cell++) {
+		grid.cell_start[cell + 1] += grid.cell_start[cell];
+	}
+	// cell_start is shifted forward by one cell while scattering and ends up back in place
+	for (int i = 0; i < count; i++) {
+		grid.boid_order[grid.cell_start[grid.boid_cell[i]]++] = i;
+	}
+	for (int cell = grid.columns * grid.rows; cell > 0; cell--) {
+		grid.cell_start[cell] = grid.cell_start[cell - 1];
+	}
+	grid.cell_start[0] = 0;
 }
 
-void AISystem::updateBoid(Entity entity, std::vector<Entity>& flock, Entity target, float elapsed_ms) {
+vec2 AISystem::steerBoid(int boid, vec2 target_position, bool follow_flow_field, float steps) const {
 	vec2 close = vec2(0, 0);
 	vec2 avgVel = vec2(0, 0);
 	vec2 avgPos = vec2(0, 0);
 	int visualCount = 0;
-	Motion& boidMotion = registry.motions.get(entity);
-	for (int i = 0; i < flock.size(); i++) {
-		if (flock[i] == entity) continue;
-		Motion& otherMotion = registry.motions.get(flock[i]);
-		vec2 diff = boidMotion.position - otherMotion.position;
-		if (magnitude(diff) < separationRadius) {
-			// Separation Force
-			close += diff;
-		} else if (magnitude(diff) < visualRadius) {
-			// Alignment Force
-			avgVel += otherMotion.velocity;
-			// Cohesion Force
-			avgPos += otherMotion.position;
-			visualCount++;
+	vec2 position = positions[boid];
+	vec2 velocity = velocities[boid];
+	const float separationRadiusSq = separationRadius * separationRadius;
+	const float visualRadiusSq = visualRadius * visualRadius;
+
+	int cell = grid.boid_cell[boid];
+	int column = cell % grid.columns;
+	int row = cell / grid.columns;
+	for (int y = max(row - 1, 0); y <= min(row + 1, grid.rows - 1); y++) {
+		for (int x = max(column - 1, 0); x <= min(column + 1, grid.columns - 1); x++) {
+			int neighbour_cell = y * grid.columns + x;
+			for (int k = grid.cell_start[neighbour_cell]; k < grid.cell_start[neighbour_cell + 1]; k++) {
+				int other = grid.boid_order[k];
+				if (other == boid) continue;
+				vec2 diff = position - positions[other];
+				float distSq = dot(diff, diff);
+				if (distSq < separationRadiusSq) {
+					// Separation Force
+					close += diff;
+				} else if (distSq < visualRadiusSq) {
+					// Alignment Force
+					avgVel += velocities[other];
+					// Cohesion Force
+					avgPos += positions[other];
+					visualCount++;
+				}
+			}
 		}
 	}
+	vec2 steering = vec2(0, 0);
 	if (visualCount > 0) {
 		avgVel /= visualCount;
 		avgPos /= visualCount;
-		boidMotion.velocity += (avgVel - boidMotion.velocity) * alignmentWeight;
-			+ (avgPos - boidMotion.position) * cohesionWeight;
+		steering += (avgVel - velocity) * alignmentWeight;
+			+ (avgPos - position) * cohesionWeight;
 	}
-	boidMotion.velocity += close * separationWeight;
+	steering += close * separationWeight;
 
 	// Edge Avoidance
-	if (boidMotion.position.x < edgeMargin) {
-		boidMotion.velocity.x += turnFactor;
-	} else if (boidMotion.position.x > window_width_px - edgeMargin) {
-		boidMotion.velocity.x -= turnFactor;
-	} else if (boidMotion.position.y < edgeMargin) {
-		boidMotion.velocity.y += turnFactor;
-	} else if (boidMotion.position.y > window_height_px - edgeMargin) {
-		boidMotion.velocity.y -= turnFactor;
+	if (position.x < edgeMargin) {
+		steering.x += turnFactor;
+	} else if (position.x > window_width_px - edgeMargin) {
+		steering.x -= turnFactor;
+	} else if (position.y < edgeMargin) {
+		steering.y += turnFactor;
+	} else if (position.y > window_height_px - edgeMargin) {
+		steering.y -= turnFactor;
 	}
 
-	boidMotion.velocity += calculateTargetForce(entity, target);
+	steering += calculateTargetForce(position, target_position, follow_flow_field);
+
+	// Boids that were not updated for a few frames make up for the steering they missed
+	velocity += steering * steps;
 
-	float speed = magnitude(boidMotion.velocity);
+	float speed = magnitude(velocity);
 
 	if (speed < minSpeed) {
-		boidMotion.velocity = normalized(boidMotion.velocity) * minSpeed;
+		velocity = normalized(velocity) * minSpeed;
 	} else if (speed > maxSpeed) {
-		boidMotion.velocity = normalized(boidMotion.velocity) * maxSpeed;
+		velocity = normalized(velocity) * maxSpeed;
 	}
+	return velocity;
+}
 
-	Motion& targetMotion = registry.motions.get(target);
-
-	if (registry.rotates.has(entity)) {
-		// Apply spinning motion separately
-		float spinSpeed = 0.0005f; // Set the speed of rotation in radians per millisecond
-		float angleChange = spinSpeed * elapsed_ms; // Calculate the angle change in radians
+vec2 AISystem::calculateTargetForce(vec2 position, vec2 target_position, bool follow_flow_field) const {
+	vec2 diff = target_position - position;
+	float dist = magnitude(diff);
+	vec2 direction = normalized(diff);
 
-		// Update the angle of the entity to simulate spinning in place
-		if (registry.rotates.get(entity).direction) {
-			boidMotion.angle += angleChange;
-		}
-		else {
-			boidMotion.angle -= angleChange;
-		}
-	}
-	else {
-		boidMotion.angle = std::atan2(targetMotion.position.y - boidMotion.position.y, targetMotion.position.x - boidMotion.position.x);
+	// Approach along the shortest path around walls instead of straight at the target
+	vec2 path_direction;
+	if (follow_flow_field && dist > targetRadius && flowField.sample(position, path_direction)) {
+		direction = path_direction;
 	}
+	return direction * (dist - targetRadius) * targetWeight;
 }
-
-vec2 AISystem::calculateTargetForce(Entity boid, Entity target) {
-	Motion& boidMotion = registry.motions.get(boid);
-	Motion& targetMotion = registry.motions.get(target);
-	vec2 diff = targetMotion.position - boidMotion.position;
-	float dist = magnitude(diff);
-	return normalized(diff) * (dist - targetRadius) * targetWeight;
-}
\ No newline at end of file
@@ -4,6 +4,8 @@
 
 #include "tiny_ecs_registry.hpp"
 #include "common.hpp"
+#include "thread_pool.hpp"
+#include "flow_field.hpp"
 
 // !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
 // DON'T WORRY ABOUT THIS CLASS UNTIL ASSIGNMENT 3
@@ -27,8 +29,59 @@ public:
 	float maxSpeed = 300.0f;
 	float minSpeed = 100.0f;
 
+	// Level of detail for steering updates
+	// Agents within lodNearDistance of their target steer every frame, within lodFarDistance every
+	// lodMidInterval frames and every lodFarInterval frames beyond that
+	bool lodEnabled = true;
+	float lodNearDistance = 700.f;
+	float lodFarDistance = 1200.f;
+	int lodMidInterval = 2;
+	int lodFarInterval = 4;
+	// Upper bound on steering updates per frame over all flocks, 0 for no limit
+	// The most overdue agents are updated first when the budget runs out
+	int maxAgentUpdatesPerFrame = 0;
+	// Agents that were skipped for longer than this do not steer any harder to catch up
+	const int maxCatchUpFrames = 8;
+
+	// Number of agents that had their steering updated in the last step and the number of agents in total
+	int updatedAgents = 0;
+	int totalAgents = 0;
+
 private:
+	// Uniform grid over the boids of one flock with a cell size of visualRadius
+	// Boids are bucketed by cell so that neighbours only need to be searched for in the 3x3 surrounding cells
+	struct NeighbourGrid {
+		vec2 origin = { 0.f, 0.f };
+		int columns = 0;
+		int rows = 0;
+		std::vector<int> cell_start; // first index into boid_order for each cell, one extra entry marks the end
+		std::vector<int> boid_order; // boid indices sorted by cell
+		std::vector<int> boid_cell;  // cell of each boid
+	};
+
+	// Flocks are updated in two phases
+	// New velocities are computed in parallel from a snapshot of the flock and then written back
+	// so the result does not depend on the order the boids are processed in
+	ThreadPool workers;
+
+	// Paths around walls toward the player, shared by every flock chasing the player
+	FlowField flowField;
+	const int boidsPerTask = 128;
+
+	// Per flock scratch buffers, reused between frames
+	NeighbourGrid grid;
+	std::vector<vec2> positions;
+	std::vector<vec2> velocities;
+	std::vector<vec2> newVelocities;
+	std::vector<int> dueBoids;
+	std::vector<int> dueSteps;
+	// Agents over all flocks that steer this frame
+	std::vector<Entity> dueAgents;
+
+	void scheduleAgents();
 	void updateBoids(Entity flock, float elapsed_ms);
-	void updateBoid(Entity boid, std::vector<Entity>& flock, Entity Target, float elapsed_ms);
-	vec2 calculateTargetForce(Entity boid, Entity target);
+	void buildGrid();
+	int updateInterval(float distance) const;
+	vec2 steerBoid(int boid, vec2 target_position, bool follow_flow_field, float steps) const;
+	vec2 calculateTargetForce(vec2 position, vec2 target_position, bool follow_flow_field) const;
 };
\ No newline at end of file
@@ -0,0 +1,72 @@
+// internal
+#include "alloc_tracker.hpp"
+
+// stlib
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifdef TRACK_ALLOCATIONS
+static std::atomic<long long> allocation_count(0);
+static std::atomic<long long> allocation_bytes(0);
+static std::atomic<long long> free_count(0);
+static thread_local bool thread_excluded = false;
+
+// operator new[] and delete[] forward to these
+void* operator new(size_t size)
+{
+	if (!thread_excluded) {
+		allocation_count.fetch_add(1, std::memory_order_relaxed);
+		allocation_bytes.fetch_add((long long)size, std::memory_order_relaxed);
+	}
+	void* ptr = malloc(size ? size : 1);
+	if (!ptr)
+		throw std::bad_alloc();
+	return ptr;
+}
+
+void operator delete(void* ptr) noexcept
+{
+	if (ptr && !thread_excluded)
+		free_count.fetch_add(1, std::memory_order_relaxed);
+	free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+	operator delete(ptr);
+}
+
+AllocStats alloc_stats()
+{
+	AllocStats stats;
+	stats.count = allocation_count.load(std::memory_order_relaxed);
+	stats.bytes = allocation_bytes.load(std::memory_order_relaxed);
+	stats.frees = free_count.load(std::memory_order_relaxed);
+	return stats;
+}
+
+void exclude_thread_from_alloc_stats()
+{
+	thread_excluded = true;
+}
+
+bool alloc_tracking_enabled()
+{
+	return true;
+}
+#else
+AllocStats alloc_stats()
+{
+	return AllocStats();
+}
+
+void exclude_thread_from_alloc_stats()
+{
+}
+
+bool alloc_tracking_enabled()
+{
+	return false;
+}
+#endif
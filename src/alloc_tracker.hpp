@@ -0,0 +1,20 @@
+#pragma once
+
+// Counts heap allocations made through the global operator new
+// The hooks are only installed when TRACK_ALLOCATIONS is defined, otherwise every count stays 0
+// Allocations of the thread pool workers are counted too, so a zone also sees the allocations made by the workers while it was open
+// Threads that run independently of the frame, like the room planner, opt out with exclude_thread_from_alloc_stats
+struct AllocStats {
+	long long count = 0;
+	long long bytes = 0;
+	long long frees = 0;
+};
+
+// Totals since the program started
+AllocStats alloc_stats();
+
+// Stops counting the allocations and frees of the calling thread
+void exclude_thread_from_alloc_stats();
+
+// Whether the operator new hooks are compiled in
+bool alloc_tracking_enabled();
@@ -0,0 +1,283 @@
+// internal
+#include "bullet_system.hpp"
+#include "collisions.hpp"
+#include "profiler.hpp"
+#include "tiny_ecs_registry.hpp"
+#include "world_init.hpp"
+
+// stlib
+#include <algorithm>
+#include <cmath>
+
+BulletSystem bulletSystem;
+
+const BulletStyle bullet_styles[bullet_style_count] = {
+	{ TEXTURE_ASSET_ID::ICE_SHARD_BASE, TEXTURE_ASSET_ID::ICE_SHARD_GLOW, 32.f, TEXTURE_ASSET_ID::ENEMY_BULLET_DEAD },
+	{ TEXTURE_ASSET_ID::ENERGY_BLAST_BASE, TEXTURE_ASSET_ID::ENERGY_BLAST_GLOW, 48.f, TEXTURE_ASSET_ID::TEXTURE_COUNT },
+	{ TEXTURE_ASSET_ID::BOLT_BASE, TEXTURE_ASSET_ID::BOLT_GLOW, 48.f, TEXTURE_ASSET_ID::BULLET_DEAD_ZAPPER },
+	{ TEXTURE_ASSET_ID::FIRE_BASE, TEXTURE_ASSET_ID::FIRE_GLOW, 48.f, TEXTURE_ASSET_ID::TEXTURE_COUNT },
+};
+
+// The collider is a box along the direction of flight, as long as the sprite and half as wide
+const float bullet_half_length = 0.5f;
+const float bullet_half_width = 0.25f;
+// Distance of the box corners from the center relative to the scale
+static const float bullet_reach = sqrt(bullet_half_length * bullet_half_length + bullet_half_width * bullet_half_width);
+
+// Moves the fields of the bullets that are kept to the front, keeping their order
+template <typename T>
+static void compact(std::vector<T>& field, const std::vector<unsigned char>& removed)
+{
+	size_t kept = 0;
+	for (size_t i = 0; i < field.size(); i++) {
+		if (!removed[i])
+			field[kept++] = field[i];
+	}
+	field.resize(kept);
+}
+
+// destination[i] += source[i] * scale
+static void add_scaled(float* destination, const float* source, float scale, int count)
+{
+	for (int i = 0; i < count; i++)
+		destination[i] += source[i] * scale;
+}
+
+static bool overlaps(vec2 min1, vec2 max1, vec2 min2, vec2 max2)
+{
+	return min1.x <= max2.x && min2.x <= max1.x && min1.y <= max2.y && min2.y <= max1.y;
+}
+
+static int clamped_column(float x)
+{
+	return std::min(std::max((int)floor(x / BulletSystem::cell_size), 0), BulletSystem::columns - 1);
+}
+
+static int clamped_row(float y)
+{
+	return std::min(std::max((int)floor(y / BulletSystem::cell_size), 0), BulletSystem::rows - 1);
+}
+
+void BulletSystem::reserve(size_t count)
+{
+	position_x.reserve(count);
+	position_y.reserve(count);
+	velocity_x.reserve(count);
+	velocity_y.reserve(count);
+	speed.reserve(count);
+	range_left.reserve(count);
+	damage.reserve(count);
+	angle.reserve(count);
+	style.reserve(count);
+	removed.reserve(count);
+	player_hits.reserve(count);
+}
+
+void BulletSystem::spawn(vec2 position, float angle, float speed, float max_distance, float damage, BULLET_STYLE style)
+{
+	position_x.push_back(position.x);
+	position_y.push_back(position.y);
+	velocity_x.push_back(speed * cos(angle));
+	velocity_y.push_back(speed * sin(angle));
+	this->speed.push_back(speed);
+	range_left.push_back(max_distance);
+	this->damage.push_back(damage);
+	this->angle.push_back(angle);
+	this->style.push_back(style);
+}
+
+void BulletSystem::clear()
+{
+	position_x.clear();
+	position_y.clear();
+	velocity_x.clear();
+	velocity_y.clear();
+	speed.clear();
+	range_left.clear();
+	damage.clear();
+	angle.clear();
+	style.clear();
+	player_hits.clear();
+}
+
+void BulletSystem::step(float elapsed_ms)
+{
+	PROFILE_SCOPE("BulletSystem::step");
+	int count = (int)size();
+	if (count == 0)
+		return;
+
+	// Integrate one field at a time, each loop only has two arrays that could alias so the compiler vectorizes it
+	float step_seconds = elapsed_ms / 1000.f;
+	add_scaled(position_x.data(), velocity_x.data(), step_seconds, count);
+	add_scaled(position_y.data(), velocity_y.data(), step_seconds, count);
+	add_scaled(range_left.data(), speed.data(), -step_seconds, count);
+	const float* px = position_x.data();
+	const float* py = position_y.data();
+	const float* vx = velocity_x.data();
+	const float* vy = velocity_y.data();
+	const float* range = range_left.data();
+
+	// Refreshing the collision cache can move its entries, so the walls go first and the player entry is fetched last
+	build_wall_grid();
+	// Points into the player container, a default Entity would allocate a new id every step
+	const Entity* player = nullptr;
+	bool player_hittable = false;
+	if (registry.players.size() > 0) {
+		player = &registry.players.entities[0];
+		// A dodging player can't be hit, like in PhysicsSystem::valid_collision
+		player_hittable = registry.collisionMeshes.has(*player) && registry.motions.has(*player) && !registry.dodgeTimers.has(*player);
+		if (player_hittable)
+			refreshCollisionCache(*player);
+	}
+
+	removed.assign(count, 0);
+	bool any_removed = false;
+	for (int i = 0; i < count; i++) {
+		if (range[i] < 0.f) {
+			TEXTURE_ASSET_ID particles_texture = bullet_styles[(int)style[i]].dead_particles;
+			if (particles_texture != TEXTURE_ASSET_ID::TEXTURE_COUNT) {
+				Entity particles = createParticleSystem(vec2(px[i], py[i]), vec2(vx[i], vy[i]), 10, 150.f, 0.f, 8, particles_texture);
+				registry.particleSystems.get(particles).texture_glow = TEXTURE_ASSET_ID::BULLET_DEAD_GLOW;
+			}
+			removed[i] = 1;
+		}
+		else if (player_hittable && hits_player(i, *player)) {
+			player_hits.push_back(damage[i]);
+			removed[i] = 1;
+		}
+		else if (hits_wall(i)) {
+			removed[i] = 1;
+		}
+		any_removed |= removed[i] != 0;
+	}
+
+	if (any_removed) {
+		compact(position_x, removed);
+		compact(position_y, removed);
+		compact(velocity_x, removed);
+		compact(velocity_y, removed);
+		compact(speed, removed);
+		compact(range_left, removed);
+		compact(damage, removed);
+		compact(angle, removed);
+		compact(style, removed);
+	}
+}
+
+void BulletSystem::build_wall_grid()
+{
+	// Every solid obstacle, the same ones the ECS projectiles are destroyed by
+	walls.clear();
+	wall_min.clear();
+	wall_max.clear();
+	for (int i = 0; i < (int)registry.collisionMeshes.size(); i++) {
+		Entity entity = registry.collisionMeshes.entities[i];
+		if (!registry.collisionMeshes.components[i].is_solid || !registry.motions.has(entity))
+			continue;
+		COLLISION_CATEGORY category = getCollisionCategory(entity);
+		if (category != COLLISION_CATEGORY::WALL && category != COLLISION_CATEGORY::DOOR &&
+			category != COLLISION_CATEGORY::ITEM && category != COLLISION_CATEGORY::OTHER)
+			continue;
+		walls.push_back(entity);
+	}
+	for (Entity wall : walls) {
+		refreshCollisionCache(wall);
+		CollisionCacheEntry& entry = registry.collisionCache.get(wall);
+		wall_min.push_back(entry.AABB_min);
+		wall_max.push_back(entry.AABB_max);
+	}
+
+	// Bucket the walls by cell, a bullet then only looks at the cell of its center
+	// First count the walls of every cell, the running sum then gives the end of each cell in cell_walls
+	std::fill(cell_start.begin(), cell_start.end(), 0);
+	for (int w = 0; w < (int)walls.size(); w++) {
+		CellRange cells = wall_cells(w);
+		for (int row = cells.min_row; row <= cells.max_row; row++)
+			for (int column = cells.min_column; column <= cells.max_column; column++)
+				cell_start[row * columns + column]++;
+	}
+	for (int cell = 1; cell < columns * rows; cell++)
+		cell_start[cell] += cell_start[cell - 1];
+	cell_start[columns * rows] = cell_start[columns * rows - 1];
+	cell_walls.resize(cell_start[columns * rows]);
+
+	// Filling every cell back to front moves cell_start to the start of the cell and keeps the walls in order
+	for (int w = (int)walls.size() - 1; w >= 0; w--) {
+		CellRange cells = wall_cells(w);
+		for (int row = cells.min_row; row <= cells.max_row; row++)
+			for (int column = cells.min_column; column <= cells.max_column; column++)
+				cell_walls[--cell_start[row * columns + column]] = w;
+	}
+}
+
+BulletSystem::CellRange BulletSystem::wall_cells(int wall) const
+{
+	// Inflated by the biggest bullet so that every wall a bullet can touch is in the cell of its center
+	float inflate = bullet_reach * bullet_styles[(int)BULLET_STYLE::ENERGY_BLAST].scale;
+	CellRange cells;
+	cells.min_column = clamped_column(wall_min[wall].x - inflate);
+	cells.max_column = clamped_column(wall_max[wall].x + inflate);
+	cells.min_row = clamped_row(wall_min[wall].y - inflate);
+	cells.max_row = clamped_row(wall_max[wall].y + inflate);
+	return cells;
+}
+
+void BulletSystem::set_bullet_polygon(int bullet)
+{
+	float scale = bullet_styles[(int)style[bullet]].scale;
+	vec2 length_axis = vec2(cos(angle[bullet]), sin(angle[bullet])) * (scale * bullet_half_length);
+	vec2 width_axis = vec2(-sin(angle[bullet]), cos(angle[bullet])) * (scale * bullet_half_width);
+	vec2 center = vec2(position_x[bullet], position_y[bullet]);
+	bullet_vertices[0] = center - length_axis - width_axis;
+	bullet_vertices[1] = center + length_axis - width_axis;
+	bullet_vertices[2] = center + length_axis + width_axis;
+	bullet_vertices[3] = center - length_axis + width_axis;
+}
+
+bool BulletSystem::hits_wall(int bullet)
+{
+	vec2 center = vec2(position_x[bullet], position_y[bullet]);
+	float reach = bullet_reach * bullet_styles[(int)style[bullet]].scale;
+	vec2 bullet_min = center - vec2(reach);
+	vec2 bullet_max = center + vec2(reach);
+	int cell = clamped_row(center.y) * columns + clamped_column(center.x);
+
+	bool polygon_set = false;
+	float overlap;
+	vec2 normal;
+	for (int k = cell_start[cell]; k < cell_start[cell + 1]; k++) {
+		int w = cell_walls[k];
+		if (!overlaps(bullet_min, bullet_max, wall_min[w], wall_max[w]))
+			continue;
+		if (!polygon_set) {
+			set_bullet_polygon(bullet);
+			polygon_set = true;
+		}
+		CollisionCacheEntry& entry = registry.collisionCache.get(walls[w]);
+		CollisionMesh& mesh = registry.collisionMeshes.get(walls[w]);
+		for (ColliderPolygon& polygon : mesh.polygons) {
+			if (collidesConvexPolygons(bullet_vertices, bullet_indices, entry.vertices, polygon, overlap, normal))
+				return true;
+		}
+	}
+	return false;
+}
+
+bool BulletSystem::hits_player(int bullet, Entity player)
+{
+	vec2 center = vec2(position_x[bullet], position_y[bullet]);
+	float reach = bullet_reach * bullet_styles[(int)style[bullet]].scale;
+	CollisionCacheEntry& entry = registry.collisionCache.get(player);
+	if (!overlaps(center - vec2(reach), center + vec2(reach), entry.AABB_min, entry.AABB_max))
+		return false;
+
+	set_bullet_polygon(bullet);
+	float overlap;
+	vec2 normal;
+	for (ColliderPolygon& polygon : registry.collisionMeshes.get(player).polygons) {
+		if (collidesConvexPolygons(bullet_vertices, bullet_indices, entry.vertices, polygon, overlap, normal))
+			return true;
+	}
+	return false;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+// internal
+#include "common.hpp"
+#include "components.hpp"
+#include "tiny_ecs.hpp"
+
+// stlib
+#include <vector>
+
+// Looks of the bullets fired by enemies and bosses, one draw call each
+enum class BULLET_STYLE {
+	ICE_SHARD = 0,
+	ENERGY_BLAST = ICE_SHARD + 1,
+	BOLT = ENERGY_BLAST + 1,
+	FIRE = BOLT + 1,
+	STYLE_COUNT = FIRE + 1
+};
+const int bullet_style_count = (int)BULLET_STYLE::STYLE_COUNT;
+
+struct BulletStyle {
+	TEXTURE_ASSET_ID texture_base;
+	TEXTURE_ASSET_ID texture_glow;
+	float scale;
+	// Particles left behind when the bullet runs out of range, TEXTURE_COUNT for none
+	TEXTURE_ASSET_ID dead_particles;
+};
+extern const BulletStyle bullet_styles[bullet_style_count];
+
+// Enemy and boss bullets, kept out of the ECS in one flat array per field
+// They only ever hit the player and solid obstacles, so they skip the generic collision pass:
+// the integration is a plain loop over the arrays, walls are looked up in a coarse grid rebuilt every step
+// and the player is tested with its cached collider
+class BulletSystem
+{
+public:
+	static const int cell_size = 60;
+	static const int columns = window_width_px / cell_size;
+	static const int rows = window_height_px / cell_size;
+
+	// Makes room for count bullets so spawning doesn't allocate
+	void reserve(size_t count);
+
+	void spawn(vec2 position, float angle, float speed, float max_distance, float damage, BULLET_STYLE style);
+
+	// Moves the bullets, expires the ones out of range and removes the ones that hit an obstacle or the player
+	// The damage of the bullets that hit the player is added to player_hits for the world system
+	void step(float elapsed_ms);
+
+	// Removes all bullets, called when the room changes
+	void clear();
+
+	size_t size() const { return position_x.size(); }
+	size_t capacity() const { return position_x.capacity(); }
+
+	// Bullet fields, all indexed the same way, in spawn order
+	std::vector<float> position_x;
+	std::vector<float> position_y;
+	std::vector<float> velocity_x;
+	std::vector<float> velocity_y;
+	std::vector<float> speed;
+	std::vector<float> range_left;
+	std::vector<float> damage;
+	std::vector<float> angle;
+	std::vector<BULLET_STYLE> style;
+
+	// Damage of every bullet that hit the player in the last step, in order
+	std::vector<float> player_hits;
+
+private:
+	struct CellRange {
+		int min_column, max_column, min_row, max_row;
+	};
+
+	void build_wall_grid();
+	CellRange wall_cells(int wall) const;
+	bool hits_wall(int bullet);
+	bool hits_player(int bullet, Entity player);
+	void set_bullet_polygon(int bullet);
+
+	// Bullets that hit something or ran out of range in this step
+	std::vector<unsigned char> removed;
+
+	// Solid obstacles bucketed by the cells their bounds (inflated by the biggest bullet) cover
+	// cell_start[c] to cell_start[c + 1] is the range of cell c in cell_walls
+	std::vector<Entity> walls;
+	std::vector<vec2> wall_min;
+	std::vector<vec2> wall_max;
+	std::vector<int> cell_start = std::vector<int>(columns * rows + 1, 0);
+	std::vector<int> cell_walls;
+
+	// Corners of the bullet tested in the narrow phase
+	ColliderVertices bullet_vertices = ColliderVertices(4);
+	ColliderPolygon bullet_indices = { 0, 1, 2, 3 };
+};
+
+extern BulletSystem bulletSystem;
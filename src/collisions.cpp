@@ -71,7 +71,7 @@ bool collides_SAT(Entity entity1, Entity entity2, float& collision_overlap, vec2
 	return detected;
 }
 
-bool collidesConvexPolygons(std::vector<vec2>& vertices1, std::vector<int>& indices1, std::vector<vec2>& vertices2, std::vector<int>& indices2, float& min_overlap, vec2& collision_normal)
+bool collidesConvexPolygons(ColliderVertices& vertices1, ColliderPolygon& indices1, ColliderVertices& vertices2, ColliderPolygon& indices2, float& min_overlap, vec2& collision_normal)
 {	
 	vec2 edge, normal;
 	float min1, max1, min2, max2;
@@ -170,47 +170,55 @@ void insertCollisionCache(Entity entity)
 
 std::unordered_map<std::string, std::pair<std::vector<ColoredVertex>, std::vector<uint16>>> meshColliderCache;
 
+COLLISION_CATEGORY getCollisionCategory(Entity entity)
+{
+	if (registry.projectiles.has(entity)) return COLLISION_CATEGORY::PROJECTILE;
+	if (registry.players.has(entity)) return COLLISION_CATEGORY::PLAYER;
+	if (registry.enemies.has(entity)) return COLLISION_CATEGORY::ENEMY;
+	if (registry.bosses.has(entity)) return COLLISION_CATEGORY::BOSS;
+	if (registry.walls.has(entity)) return COLLISION_CATEGORY::WALL;
+	if (registry.doors.has(entity)) return COLLISION_CATEGORY::DOOR;
+	if (registry.items.has(entity)) return COLLISION_CATEGORY::ITEM;
+	return COLLISION_CATEGORY::OTHER;
+}
+
 struct CollisionMesh createMeshCollider(Entity entity, std::string path)
 {
-	std::vector<ColoredVertex> outVerticies = std::vector<ColoredVertex>();
-	std::vector<uint16_t> outVertexIndecies = std::vector<uint16_t>();
-	vec2 out_size = vec2();
+	assert(registry.motions.has(entity));
+	return createMeshCollider(registry.motions.get(entity).scale, path);
+}
 
-	if (meshColliderCache.find(path) != meshColliderCache.end())
-	{
-		std::pair<std::vector<ColoredVertex>, std::vector<uint16>> data = meshColliderCache[path];
-		outVerticies = data.first;
-		outVertexIndecies = data.second;
-	}
-	else
+struct CollisionMesh createMeshCollider(vec2 scale, std::string path)
+{
+	if (meshColliderCache.find(path) == meshColliderCache.end())
 	{
+		std::vector<ColoredVertex> outVerticies;
+		std::vector<uint16_t> outVertexIndecies;
+		vec2 out_size = vec2();
 		Mesh::loadBlenderFromOBJFile(mesh_path(path), outVerticies, outVertexIndecies, out_size);
-		std::pair<std::vector<ColoredVertex>, std::vector<uint16>> data = { outVerticies, outVertexIndecies };
-		meshColliderCache[path] = data;
+		meshColliderCache[path] = { outVerticies, outVertexIndecies };
 	}
-
-	assert(registry.motions.has(entity));
-
-	Motion& entityMotion = registry.motions.get(entity);
+	const std::pair<std::vector<ColoredVertex>, std::vector<uint16>>& data = meshColliderCache[path];
+	const std::vector<ColoredVertex>& outVerticies = data.first;
+	const std::vector<uint16_t>& outVertexIndecies = data.second;
 
 	// printf("Creating collider mesh with %ld verticies and %ld indecies\n", (int)outVerticies.size(), (int)outVertexIndecies.size());
-	// printf("Scale is X: %f, Y: %f\n", entityMotion.scale.x, entityMotion.scale.y);
+	// printf("Scale is X: %f, Y: %f\n", scale.x, scale.y);
 
-	vec2 scaleMultiplier = entityMotion.scale * vec2(0.5f, 0.5f);
+	vec2 scaleMultiplier = scale * vec2(0.5f, 0.5f);
 	CollisionMesh cm;
+	cm.vertices.reserve(outVerticies.size());
 	for (int i = 0; i < outVerticies.size(); i++)
 	{
 		vec3 source = outVerticies[i].position;
 		vec2 vertex = vec2(source.x, source.z);
 		cm.vertices.push_back(vertex * scaleMultiplier);
-
-		vec2 scaled = vertex * scaleMultiplier;
-		// printf("Vertex from %f, %f now at %f, %f\n", vertex.x, vertex.y, scaled.x, scaled.y);
 	}
 
+	cm.polygons.reserve(outVertexIndecies.size() / 3);
 	for (uint16_t i = 0; i < outVertexIndecies.size(); i += 3)
 	{
-		std::vector<int> shape = std::vector<int>();
+		ColliderPolygon shape;
 		shape.push_back(outVertexIndecies[i + 0]);
 		shape.push_back(outVertexIndecies[i + 1]);
 		shape.push_back(outVertexIndecies[i + 2]);
@@ -239,7 +247,7 @@ struct CollisionMesh createBoxCollisionMesh(Entity entity, vec2 mesh_scale)
 	mesh.vertices.push_back({ scale.x / 2, -scale.y / 2 });
 	mesh.vertices.push_back({ scale.x / 2, scale.y / 2 });
 	mesh.vertices.push_back({ -scale.x / 2, scale.y / 2 });
-	std::vector<int> box = { 0, 1, 2, 3 };
+	ColliderPolygon box = { 0, 1, 2, 3 };
 	mesh.polygons.push_back(box);
 
 	return mesh;
@@ -287,20 +295,23 @@ struct CollisionMesh createCapsuleCollisionMesh(Entity entity, float radius_to_h
 			mesh.vertices.push_back(vec2(radius * cos(angle), radius * sin(angle) - rectangle_half_length));
 		}
 	}
-	std::vector<int> capsule;
+	mesh.polygons.resize(1);
+	ColliderPolygon& capsule = mesh.polygons[0];
 	for (int i = 0; i < circle_segments * 2; i++) {
 		capsule.push_back(i);
 	}
-	mesh.polygons.push_back(capsule);
 	return mesh;
 }
 
 struct CollisionMesh createEllipseCollisionMesh(Entity entity, int circle_segments)
 {
-	// Get the motion component
-	Motion& motion = registry.motions.get(entity);
-	float half_width = std::abs(motion.scale.x) / 2;
-	float half_height = std::abs(motion.scale.y) / 2;
+	return createEllipseCollisionMesh(registry.motions.get(entity).scale, circle_segments);
+}
+
+struct CollisionMesh createEllipseCollisionMesh(vec2 scale, int circle_segments)
+{
+	float half_width = std::abs(scale.x) / 2;
+	float half_height = std::abs(scale.y) / 2;
 
 	float angle_step = 2 * M_PI / (circle_segments);
 	// Create the collision mesh
@@ -311,11 +322,11 @@ struct CollisionMesh createEllipseCollisionMesh(Entity entity, int circle_segmen
 		float angle = angle_step * i;
 		mesh.vertices.push_back(vec2(half_width * cos(angle), half_height * sin(angle)));
 	}
-	std::vector<int> ellipse;
+	mesh.polygons.resize(1);
+	ColliderPolygon& ellipse = mesh.polygons[0];
 	for (int i = 0; i < circle_segments; i++) {
 		ellipse.push_back(i);
 	}
-	mesh.polygons.push_back(ellipse);
 	return mesh;
 }
 
@@ -335,7 +346,7 @@ struct CollisionMesh createCollisionMeshFromMesh(Entity entity)
 	}
 	// The mesh is defined by triangles
 	for (int i = 0; i < mesh->vertex_indices.size(); i += 3) {
-		std::vector<int> triangle;
+		ColliderPolygon triangle;
 		triangle.push_back(mesh->vertex_indices[i]);
 		triangle.push_back(mesh->vertex_indices[i + 1]);
 		triangle.push_back(mesh->vertex_indices[i + 2]);
@@ -345,7 +356,7 @@ struct CollisionMesh createCollisionMeshFromMesh(Entity entity)
 	return collision_mesh;
 }
 
-void projectPolygonOntoAxis(std::vector<vec2>& vertices, std::vector<int>& indices, vec2 axis, float& min_proj, float& max_proj) {
+void projectPolygonOntoAxis(ColliderVertices& vertices, ColliderPolygon& indices, vec2 axis, float& min_proj, float& max_proj) {
 	max_proj = dot(vertices[indices[0]], axis);
 	min_proj = max_proj;
 	for (int i = 1; i < indices.size(); i++) {
@@ -365,7 +376,7 @@ vec2 getNormal(vec2 edge)
 	return vec2(-edge.y, edge.x) / length;
 }
 
-float findMin(std::vector<vec2>& vertices, AXIS axis)
+float findMin(ColliderVertices& vertices, AXIS axis)
 {
 	float min = vertices[0][axis];
 	for (int i = 1; i < vertices.size(); i++) {
@@ -376,7 +387,7 @@ float findMin(std::vector<vec2>& vertices, AXIS axis)
 	return min;
 }
 
-float findMax(std::vector<vec2>& vertices, AXIS axis)
+float findMax(ColliderVertices& vertices, AXIS axis)
 {
 	float max = vertices[0][axis];
 	for (int i = 1; i < vertices.size(); i++) {
@@ -387,7 +398,7 @@ float findMax(std::vector<vec2>& vertices, AXIS axis)
 	return max;
 }
 
-void rotateVertices(std::vector<vec2>& vertices, float angle)
+void rotateVertices(ColliderVertices& vertices, float angle)
 {
 	for (int i = 0; i < vertices.size(); i++) {
 		float x = vertices[i].x;
@@ -397,7 +408,7 @@ void rotateVertices(std::vector<vec2>& vertices, float angle)
 	}
 }
 
-void translateVertices(std::vector<vec2>& vertices, vec2 postition) {
+void translateVertices(ColliderVertices& vertices, vec2 postition) {
 	for (int i = 0; i < vertices.size(); i++) {
 		vertices[i] += postition;
 	}
@@ -22,9 +22,15 @@ bool collides_AABB(Entity entity1, Entity entity2, float& min_overlap, vec2& col
 bool collides_SAT(Entity entity1, Entity entity2, float& min_overlap, vec2& collision_normal);
 
 // Checks whether two convex polygons are colliding
-bool collidesConvexPolygons(std::vector<vec2>& vertices1, std::vector<int>& indices1, std::vector<vec2>& vertices2, std::vector<int>& indices2, float& min_overlap, vec2& collision_normal);
+bool collidesConvexPolygons(ColliderVertices& vertices1, ColliderPolygon& indices1, ColliderVertices& vertices2, ColliderPolygon& indices2, float& min_overlap, vec2& collision_normal);
+
+// Returns the collision category of the entity
+// An entity is categorized by the first matching component in the order of COLLISION_CATEGORY
+COLLISION_CATEGORY getCollisionCategory(Entity entity);
 
 struct CollisionMesh createMeshCollider(Entity entity, std::string path);
+// Same as above for an entity of the given scale, prefabs build their colliders before there is an entity
+struct CollisionMesh createMeshCollider(vec2 scale, std::string path);
 
 // Creates a collision mesh box for the entity
 // Mesh_scale is the scale of the collision mesh relative to the scale of the entity
@@ -39,27 +45,28 @@ struct CollisionMesh createCapsuleCollisionMesh(Entity entity, float radius_to_h
 // creates an ellipse collision mesh
 // if the scale of the entity is equal in x and y directions the ellipse will be a circle
 struct CollisionMesh createEllipseCollisionMesh(Entity entity, int circle_segments);
+struct CollisionMesh createEllipseCollisionMesh(vec2 scale, int circle_segments);
 
 // Creates a collision mesh from the mesh of the entity
 struct CollisionMesh createCollisionMeshFromMesh(Entity entity);
 
 // Projects the vertices onto the given axis and returns the minimum and maximum projections
-void projectPolygonOntoAxis(std::vector<vec2>& vertices, std::vector<int>& indices, vec2 axis, float& min_proj, float& max_proj);
+void projectPolygonOntoAxis(ColliderVertices& vertices, ColliderPolygon& indices, vec2 axis, float& min_proj, float& max_proj);
 
 // Returns the normal of the edge
 vec2 getNormal(vec2 edge);
 
 // Returns the minimum value of the vertices in the given axis
-float findMin(std::vector<vec2>& vertices, AXIS axis);
+float findMin(ColliderVertices& vertices, AXIS axis);
 
 // Returns the maximum value of the vertices in the given axis
-float findMax(std::vector<vec2>& vertices, AXIS axis);
+float findMax(ColliderVertices& vertices, AXIS axis);
 
 // Rotates the vertices by the given angle around (0,0)
-void rotateVertices(std::vector<vec2>& vertices, float angle);
+void rotateVertices(ColliderVertices& vertices, float angle);
 
 // Translates the vertices by the given position
-void translateVertices(std::vector<vec2>& vertices, vec2 position);
+void translateVertices(ColliderVertices& vertices, vec2 position);
 
 // Refreshes the collision cache entry for the entity if the entity has moved or rotated since the last collision check
 void refreshCollisionCache(Entity entity);
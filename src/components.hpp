@@ -1,5 +1,6 @@
 #pragma once
 #include "common.hpp"
+#include "small_vector.hpp"
 #include <vector>
 #include <unordered_map>
 #include "../ext/stb_image/stb_image.h"
@@ -7,12 +8,12 @@
 
 struct SplineBullet
 {
+	// Index of the bullet's path in splineArena, freed with the component
+	int curve = -1;
 	float total_distance;
 	float distance_covered = 0.f;
 	float speed = 600.f;
 	bool last_point_crossed = false;
-	int last_point = 0;
-	std::vector<vec2> points_on_line;
 };
 
 // Player component
@@ -41,6 +42,7 @@ enum class ENEMY_ID {
 	FLAMETHROWER = ZAPPER + 1,
 	BOMBER = FLAMETHROWER + 1
 };
+const int enemy_type_count = (int)ENEMY_ID::BOMBER + 1;
 
 struct Enemy
 {
@@ -88,7 +90,8 @@ struct Projectile
 	float max_distance = 2000.f;
 	float distance_travelled = 0.f;
 	float damage = 10.f;
-	std::vector<Entity> hit_entities;
+	// Piercing and ricochet bullets hit a few entities at most
+	SmallVector<Entity, 4> hit_entities;
 };
 
 enum class GUN_ID {
@@ -160,28 +163,59 @@ struct Boid
 
 struct Flock
 {
-	std::vector<Entity> boids;
+	SmallVector<Entity, 16> boids;
 	Entity target;
 };
 
+// Marks a boid as part of a flock
+// index is the position of the boid in Flock::boids and is kept up to date when other boids leave the flock
+struct FlockMember
+{
+	Entity flock;
+	unsigned int index = 0;
+};
+
 
 // Stucture to store collision information
+// Coarse role an entity plays in a collision
+// Used to look up the handler for a pair of colliding entities
+enum class COLLISION_CATEGORY {
+	PROJECTILE = 0,
+	PLAYER = PROJECTILE + 1,
+	ENEMY = PLAYER + 1,
+	BOSS = ENEMY + 1,
+	WALL = BOSS + 1,
+	DOOR = WALL + 1,
+	ITEM = DOOR + 1,
+	OTHER = ITEM + 1,
+	CATEGORY_COUNT = OTHER + 1
+};
+const int collision_category_count = (int)COLLISION_CATEGORY::CATEGORY_COUNT;
+
 struct Collision
 {
 	// Note, the first object is stored in the ECS container.entities
 	Entity other_entity; // the second object involved in the collision
-	Collision(Entity& other_entity) { this->other_entity = other_entity; };
+	Collision(Entity& other_entity) : other_entity(other_entity) {};
 	float min_overlap = 0.f;
 	vec2 overlap_normal = { 0.f, 0.f };
+	// Categories of the first and second object, assigned when the collision is detected
+	COLLISION_CATEGORY category = COLLISION_CATEGORY::OTHER;
+	COLLISION_CATEGORY other_category = COLLISION_CATEGORY::OTHER;
 };
 
+// Bullets, characters and boxes have at most 10 vertices in a single polygon, their meshes are stored inline
+// Meshes loaded from models spill to the heap
+typedef SmallVector<vec2, 12> ColliderVertices;
+typedef SmallVector<int, 12> ColliderPolygon;
+
 // Defines the structure around an object which can collide with other objects
 // The structure is defined by a set of vertices and a set of polygons
 // Each individual polygon must be convex but the total shape can be non-convex
 struct CollisionMesh
 {
-	std::vector<vec2> vertices;
-	std::vector<std::vector<int>> polygons;
+	ColliderVertices vertices;
+	SmallVector<ColliderPolygon, 1> polygons;
 	bool is_solid = true;
 	bool is_static = false;
 };
@@ -190,7 +224,7 @@ struct CollisionMesh
 // Calculated once per frame per entity
 struct CollisionCacheEntry
 {
-	std::vector<vec2> vertices;
+	ColliderVertices vertices;
 	vec2 AABB_min;
 	vec2 AABB_max;
 	vec2 position;
@@ -376,6 +410,15 @@ struct Rotate {
 	bool direction;
 };
 
+// How often the AI updates the steering of an agent
+// Agents further from the player steer less often and keep their velocity in between
+struct AiSchedule {
+	int frames_since_update = 0;
+	int interval = 1;
+	// Steering steps to apply this frame, 0 when the agent is not updated this frame
+	int steps = 0;
+};
+
 /**
  * The following enumerators represent global identifiers refering to graphic
  * assets. For example TEXTURE_ASSET_ID are the identifiers of each texture
@@ -485,7 +528,8 @@ enum class EFFECT_ASSET_ID {
 	TEXTURED_GLOW = BLOOM + 1,
 	ANIMATED = TEXTURED_GLOW + 1,
 	BOSS_ANIMATE = ANIMATED + 1,
-	EFFECT_COUNT = BOSS_ANIMATE + 1
+	BULLET = BOSS_ANIMATE + 1,
+	EFFECT_COUNT = BULLET + 1
 };
 const int effect_count = (int)EFFECT_ASSET_ID::EFFECT_COUNT;
 
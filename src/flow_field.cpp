@@ -0,0 +1,148 @@
+// internal
+#include "flow_field.hpp"
+
+// stlib
+#include <functional>
+#include <limits>
+#include <queue>
+
+// Costs of straight and diagonal steps between neighbouring cells
+const int straight_cost = 10;
+const int diagonal_cost = 14;
+const int unreachable = std::numeric_limits<int>::max();
+
+const int neighbour_offsets[8][2] = {
+	{ 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 },
+	{ 1, 1 }, { 1, -1 }, { -1, 1 }, { -1, -1 }
+};
+
+int FlowField::cell_of(vec2 position) const
+{
+	int column = (int)floor(position.x / cell_size);
+	int row = (int)floor(position.y / cell_size);
+	if (column < 0 || column >= columns || row < 0 || row >= rows) return -1;
+	return row * columns + column;
+}
+
+void FlowField::update(vec2 goal)
+{
+	// Walls only appear or disappear when rooms change so the set of wall entities identifies the layout
+	size_t signature = registry.walls.size();
+	for (Entity wall : registry.walls.entities) {
+		signature = signature * 31 + std::hash<unsigned int>()(wall);
+	}
+	bool walls_changed = signature != wall_signature;
+	if (walls_changed) {
+		wall_signature = signature;
+		rasterize_walls();
+	}
+
+	int cell = cell_of(goal);
+	if (walls_changed || cell != goal_cell) {
+		goal_cell = cell;
+		compute_field(goal_cell);
+	}
+}
+
+void FlowField::rasterize_walls()
+{
+	std::fill(blocked.begin(), blocked.end(), 0);
+	for (Entity wall : registry.walls.entities) {
+		if (!registry.motions.has(wall)) continue;
+		Motion& motion = registry.motions.get(wall);
+		vec2 half_size = abs(motion.scale) / 2.f + vec2(agent_radius);
+		vec2 min_corner = motion.position - half_size;
+		vec2 max_corner = motion.position + half_size;
+
+		// Moving walls block everything they sweep through
+		if (registry.interpolations.has(wall)) {
+			Interpolation& interpolation = registry.interpolations.get(wall);
+			min_corner = min(interpolation.start_position, interpolation.end_position) - half_size;
+			max_corner = max(interpolation.start_position, interpolation.end_position) + half_size;
+		}
+
+		// A cell is blocked when its center is covered so narrow gaps between walls stay open
+		float half_cell = cell_size / 2.f;
+		int min_column = max((int)ceil((min_corner.x - half_cell) / cell_size), 0);
+		int max_column = min((int)floor((max_corner.x - half_cell) / cell_size), columns - 1);
+		int min_row = max((int)ceil((min_corner.y - half_cell) / cell_size), 0);
+		int max_row = min((int)floor((max_corner.y - half_cell) / cell_size), rows - 1);
+		for (int row = min_row; row <= max_row; row++) {
+			for (int column = min_column; column <= max_column; column++) {
+				blocked[row * columns + column] = 1;
+			}
+		}
+	}
+}
+
+void FlowField::compute_field(int goal)
+{
+	rebuild_count++;
+	std::fill(cost.begin(), cost.end(), unreachable);
+	std::fill(directions.begin(), directions.end(), vec2(0.f, 0.f));
+	if (goal < 0) return;
+
+	// Dijkstra outward from the goal
+	// The goal itself may be inside an inflated wall when the player hugs it, so it is always expanded
+	typedef std::pair<int, int> QueueEntry; // cost, cell
+	std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> open;
+	cost[goal] = 0;
+	open.push({ 0, goal });
+	while (!open.empty()) {
+		QueueEntry entry = open.top();
+		open.pop();
+		int cell = entry.second;
+		if (entry.first > cost[cell]) continue;
+
+		int column = cell % columns;
+		int row = cell / columns;
+		for (int i = 0; i < 8; i++) {
+			int next_column = column + neighbour_offsets[i][0];
+			int next_row = row + neighbour_offsets[i][1];
+			if (next_column < 0 || next_column >= columns || next_row < 0 || next_row >= rows) continue;
+			int next = next_row * columns + next_column;
+			if (blocked[next]) continue;
+			bool diagonal = i >= 4;
+			// Do not cut corners around walls
+			if (diagonal && (blocked[row * columns + next_column] || blocked[next_row * columns + column])) continue;
+
+			int next_cost = entry.first + (diagonal ? diagonal_cost : straight_cost);
+			if (next_cost < cost[next]) {
+				cost[next] = next_cost;
+				open.push({ next_cost, next });
+			}
+		}
+	}
+
+	// Point every cell at its cheapest neighbour
+	// Blocked cells point at the cheapest open neighbour so agents pushed into a wall's margin find their way out
+	for (int cell = 0; cell < columns * rows; cell++) {
+		if (cell == goal) continue;
+		int column = cell % columns;
+		int row = cell / columns;
+		int best_cost = blocked[cell] ? unreachable : cost[cell];
+		int best = -1;
+		for (int i = 0; i < 8; i++) {
+			int next_column = column + neighbour_offsets[i][0];
+			int next_row = row + neighbour_offsets[i][1];
+			if (next_column < 0 || next_column >= columns || next_row < 0 || next_row >= rows) continue;
+			int next = next_row * columns + next_column;
+			if (cost[next] < best_cost) {
+				best_cost = cost[next];
+				best = next;
+			}
+		}
+		if (best >= 0) {
+			vec2 step = vec2(best % columns - column, best / columns - row);
+			directions[cell] = step / sqrt(dot(step, step));
+		}
+	}
+}
+
+bool FlowField::sample(vec2 position, vec2& direction) const
+{
+	int cell = cell_of(position);
+	if (cell < 0 || cell == goal_cell) return false;
+	direction = directions[cell];
+	return direction != vec2(0.f, 0.f);
+}
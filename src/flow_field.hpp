@@ -0,0 +1,42 @@
+#pragma once
+
+// stlib
+#include <vector>
+
+#include "tiny_ecs_registry.hpp"
+#include "common.hpp"
+
+// A flow field over a coarse navigation grid covering the room
+// Each cell stores the direction along the shortest path around walls toward a goal cell
+// Every agent heading for the goal can then look up its direction in constant time
+class FlowField
+{
+public:
+	static const int cell_size = 60;
+	static const int columns = window_width_px / cell_size;
+	static const int rows = window_height_px / cell_size;
+
+	// Colliders are inflated by this much so agents keep clear of wall corners
+	const float agent_radius = 30.f;
+
+	// Re-rasterizes the walls if they changed and recomputes the field if the goal moved to a different cell
+	void update(vec2 goal);
+
+	// Direction of the shortest path to the goal from the given position
+	// Returns false if the position is outside the grid, in the goal cell or cannot reach the goal
+	bool sample(vec2 position, vec2& direction) const;
+
+	// Number of times the field has been recomputed, for profiling
+	int rebuild_count = 0;
+
+private:
+	void rasterize_walls();
+	void compute_field(int goal);
+	int cell_of(vec2 position) const;
+
+	std::vector<unsigned char> blocked = std::vector<unsigned char>(columns * rows, 0);
+	std::vector<int> cost = std::vector<int>(columns * rows, 0);
+	std::vector<vec2> directions = std::vector<vec2>(columns * rows, vec2(0.f, 0.f));
+	int goal_cell = -1;
+	size_t wall_signature = 0;
+};
@@ -0,0 +1,44 @@
+// internal
+#include "frame_arena.hpp"
+
+// stlib
+#include <algorithm>
+#include <new>
+
+FrameArena frameArena;
+const size_t FrameArena::initial_capacity;
+
+void* FrameArena::allocate(size_t bytes, size_t alignment)
+{
+	size_t start = (offset + alignment - 1) & ~(alignment - 1);
+	if (start + bytes <= block_size) {
+		frame_bytes += start - offset + bytes;
+		offset = start + bytes;
+		return block.get() + start;
+	}
+
+	// Out of room, ::operator new aligns for any type
+	frame_bytes += bytes;
+	void* allocation = ::operator new(bytes);
+	overflow.push_back(allocation);
+	return allocation;
+}
+
+void FrameArena::reset()
+{
+	for (void* allocation : overflow)
+		::operator delete(allocation);
+	overflow.clear();
+
+	// Grow the block so that the biggest frame so far fits without the heap
+	peak_bytes = high_water_mark();
+	if (block_size < std::max(peak_bytes, initial_capacity)) {
+		size_t size = initial_capacity;
+		while (size < peak_bytes)
+			size *= 2;
+		block.reset(new unsigned char[size]);
+		block_size = size;
+	}
+	offset = 0;
+	frame_bytes = 0;
+}
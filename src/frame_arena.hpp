@@ -0,0 +1,67 @@
+#pragma once
+
+// stlib
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Bump allocator for scratch data that only lives until the end of the frame
+// Allocating moves a pointer forward, nothing is freed until reset() at the top of the main loop drops everything at once
+// A frame that doesn't fit in the block gets the rest from the heap, the next reset grows the block to the biggest frame so far
+// Not thread safe, only the main thread uses it
+class FrameArena
+{
+public:
+	// Size of the block before any frame has outgrown it
+	static const size_t initial_capacity = 16 * 1024;
+
+	void* allocate(size_t bytes, size_t alignment);
+
+	// Frees everything allocated since the last reset, nothing allocated in the frame may be used after this
+	void reset();
+
+	// Bytes allocated since the last reset
+	size_t used() const { return frame_bytes; }
+	size_t capacity() const { return block_size; }
+	// Most bytes any frame has used, the block to reserve for a steady state without heap allocations
+	size_t high_water_mark() const { return frame_bytes > peak_bytes ? frame_bytes : peak_bytes; }
+
+private:
+	std::unique_ptr<unsigned char[]> block;
+	size_t block_size = 0;
+	size_t offset = 0;
+	size_t frame_bytes = 0;
+	size_t peak_bytes = 0;
+	// Heap allocations of this frame that didn't fit in the block
+	std::vector<void*> overflow;
+};
+
+extern FrameArena frameArena;
+
+// Allocator for standard containers that live in the frame arena
+// Freeing is a no-op, the memory comes back when the arena is reset, so the container must not outlive the frame
+template <typename T>
+struct FrameAllocator
+{
+	typedef T value_type;
+
+	FrameAllocator() {}
+	template <typename U>
+	FrameAllocator(const FrameAllocator<U>&) {}
+
+	T* allocate(size_t n)
+	{
+		return static_cast<T*>(frameArena.allocate(n * sizeof(T), alignof(T)));
+	}
+
+	void deallocate(T*, size_t) {}
+};
+
+template <typename T, typename U>
+bool operator==(const FrameAllocator<T>&, const FrameAllocator<U>&) { return true; }
+template <typename T, typename U>
+bool operator!=(const FrameAllocator<T>&, const FrameAllocator<U>&) { return false; }
+
+// Scratch vector for the current frame
+template <typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
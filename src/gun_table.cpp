@@ -0,0 +1,208 @@
+// internal
+#include "gun_table.hpp"
+#include "bullet_system.hpp"
+#include "rng.hpp"
+#include "world_init.hpp"
+
+// stlib
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+#include <sstream>
+#include <glm/trigonometric.hpp>
+
+GunTable gunTable;
+
+// Indexed by GUN_ID
+const char* const gun_id_names[gun_definition_count] = {
+	"STRAIGHT_SHOT",
+	"SPLIT_SHOT",
+	"BOUNCING_SHOT",
+	"SPLINE_SHOT",
+	"SPLIT_SPLINE_SHOT",
+	"RAPID_SHOT",
+	"LONG_SHOT",
+	"OMNI_SHOT",
+	"ZAP_SHOT",
+	"FIRE_SHOT",
+	"EXPLOSION_SHOT",
+};
+
+static bool parse_gun_id(const std::string& name, GUN_ID& id)
+{
+	for (int i = 0; i < gun_definition_count; i++) {
+		if (name == gun_id_names[i]) {
+			id = (GUN_ID)i;
+			return true;
+		}
+	}
+	return false;
+}
+
+// Reads the rest of the line, returns false if it isn't all numbers
+static bool parse_angles(std::istringstream& line, std::vector<float>& angles)
+{
+	angles.clear();
+	float angle;
+	while (line >> angle)
+		angles.push_back(angle);
+	return line.eof();
+}
+
+// A definition being read, it is compiled into the table when the next one starts
+struct PendingGun {
+	GUN_ID id;
+	bool for_player = true;
+	bool for_enemy = true;
+	GunDefinition definition;
+	std::vector<float> directions = { 0.f };
+	std::vector<float> spread = { 0.f };
+};
+
+bool GunTable::load(const std::string& path)
+{
+	std::ifstream file(path);
+	if (!file) {
+		printf("Error opening gun definitions: %s\n", path.c_str());
+		return false;
+	}
+
+	for (auto& shooter_definitions : definitions)
+		std::fill(std::begin(shooter_definitions), std::end(shooter_definitions), GunDefinition());
+	shots.clear();
+
+	std::vector<PendingGun> guns;
+	std::string text;
+	for (int line_number = 1; std::getline(file, text); line_number++) {
+		text = text.substr(0, text.find('#'));
+		std::istringstream line(text);
+		std::string property;
+		if (!(line >> property))
+			continue;
+
+		bool ok = true;
+		if (property == "gun") {
+			PendingGun gun;
+			std::string name, shooter;
+			ok = (line >> name) && parse_gun_id(name, gun.id);
+			if (ok && line >> shooter) {
+				ok = shooter == "player" || shooter == "enemy";
+				gun.for_player = shooter == "player";
+				gun.for_enemy = shooter == "enemy";
+			}
+			guns.push_back(gun);
+		}
+		else if (guns.empty()) {
+			// Properties need a gun to belong to
+			ok = false;
+		}
+		else if (property == "cooldown") {
+			ok = (bool)(line >> guns.back().definition.cooldown_ms);
+		}
+		else if (property == "speed") {
+			ok = (bool)(line >> guns.back().definition.speed);
+		}
+		else if (property == "damage") {
+			ok = (bool)(line >> guns.back().definition.damage);
+		}
+		else if (property == "range") {
+			GunDefinition& definition = guns.back().definition;
+			std::string value;
+			ok = (bool)(line >> value);
+			definition.uses_player_range = value == "player";
+			if (definition.uses_player_range) {
+				definition.range = 0.f;
+				line >> definition.range;
+			}
+			else if (ok) {
+				std::istringstream number(value);
+				ok = (bool)(number >> definition.range);
+			}
+		}
+		else if (property == "scale") {
+			ok = (bool)(line >> guns.back().definition.scale);
+		}
+		else if (property == "muzzle") {
+			ok = (bool)(line >> guns.back().definition.muzzle_offset);
+		}
+		else if (property == "jitter") {
+			ok = (bool)(line >> guns.back().definition.jitter_degrees);
+		}
+		else if (property == "directions") {
+			ok = parse_angles(line, guns.back().directions);
+		}
+		else if (property == "spread") {
+			ok = parse_angles(line, guns.back().spread);
+		}
+		else if (property == "ricochet") {
+			guns.back().definition.ricochet = true;
+		}
+		else if (property == "pierce") {
+			guns.back().definition.pierce = true;
+		}
+		else if (property == "spline") {
+			guns.back().definition.spline = true;
+		}
+		else {
+			ok = false;
+		}
+
+		if (!ok) {
+			printf("Error in gun definitions %s line %d: %s\n", path.c_str(), line_number, text.c_str());
+			return false;
+		}
+	}
+
+	// Compile the volleys, every spread angle around every direction
+	for (PendingGun& gun : guns) {
+		gun.definition.first_shot = (int)shots.size();
+		gun.definition.shot_count = (int)(gun.directions.size() * gun.spread.size());
+		for (float direction : gun.directions) {
+			for (float spread : gun.spread)
+				shots.push_back({ direction / 180.0 * M_PI, spread });
+		}
+		if (gun.for_player)
+			definitions[1][(int)gun.id] = gun.definition;
+		if (gun.for_enemy)
+			definitions[0][(int)gun.id] = gun.definition;
+	}
+	return true;
+}
+
+const GunDefinition& GunTable::get(GUN_ID id, bool fired_by_player) const
+{
+	assert((int)id < gun_definition_count && "Not a gun");
+	return definitions[fired_by_player ? 1 : 0][(int)id];
+}
+
+void GunTable::fire(GUN_ID id, vec2 position, float angle, bool shot_by_player, bool shot_by_boss, vec2 target, float player_range) const
+{
+	const GunDefinition& gun = get(id, shot_by_player);
+	float deg_to_rad = M_PI / 180.0;
+
+	float jitter = 0.f;
+	if (gun.jitter_degrees > 0.f)
+		jitter = randomService.stream(RNG_STREAM::GUNS).uniform(-gun.jitter_degrees, gun.jitter_degrees);
+	vec2 offset = { 0, 0 };
+	// glm's cos and sin stay in float like the rest of the gameplay code
+	if (shot_by_player)
+		offset = { gun.muzzle_offset * cos(angle), gun.muzzle_offset * sin(angle) };
+	float range = gun.uses_player_range ? player_range + gun.range : gun.range;
+
+	// One reserve for the whole volley, growing geometrically like push_back would
+	if (!shot_by_player) {
+		size_t needed = bulletSystem.size() + gun.shot_count;
+		if (needed > bulletSystem.capacity())
+			bulletSystem.reserve(std::max(needed, 2 * bulletSystem.capacity()));
+	}
+
+	for (int i = gun.first_shot; i < gun.first_shot + gun.shot_count; i++) {
+		const GunShot& shot = shots[i];
+		float direction = angle + shot.direction_radians;
+		float shot_angle = direction + (shot.spread_degrees + jitter) * deg_to_rad;
+		if (gun.spline)
+			createSplineBullet(position + offset, target, shot_angle, gun.speed, gun.ricochet, range, shot_by_player, shot_by_boss, gun.damage);
+		else
+			fireBullet(position + offset, shot_angle, gun.speed, gun.ricochet, range, shot_by_player, gun.pierce, gun.damage, gun.scale, id);
+	}
+}
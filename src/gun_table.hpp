@@ -0,0 +1,76 @@
+#pragma once
+
+// internal
+#include "common.hpp"
+#include "components.hpp"
+
+// stlib
+#include <string>
+#include <vector>
+
+// GUN_COUNT stops before EXPLOSION_SHOT and can't move without changing NO_GUN in the save files
+const int gun_definition_count = (int)GUN_ID::EXPLOSION_SHOT + 1;
+
+// One bullet of a volley
+struct GunShot {
+	// Direction the spread is centered on, relative to the shooter's aim
+	double direction_radians;
+	float spread_degrees;
+};
+
+// Everything a gun needs to fire, compiled from data/guns.txt
+struct GunDefinition {
+	float cooldown_ms = 300.f;
+	float speed = 0.f;
+	float damage = 0.f;
+	// Distance the bullets fly, added to the player's range stat when uses_player_range
+	float range = 0.f;
+	bool uses_player_range = false;
+	float scale = 1.f;
+	// The player's shots start this far in front of the player
+	float muzzle_offset = 0.f;
+	// The whole volley is turned by a random angle up to this many degrees either way
+	float jitter_degrees = 0.f;
+	bool ricochet = false;
+	bool pierce = false;
+	bool spline = false;
+	// Range of the volley in GunTable::shots
+	int first_shot = 0;
+	int shot_count = 1;
+};
+
+// Gun definitions indexed by GUN_ID, separately for the player and for enemies and bosses
+// The volleys of all guns are stored back to back in one array so firing is a single loop over it
+//
+// data/guns.txt has one property per line, everything after a # is a comment. Angles are in degrees
+//   gun <GUN_ID> [player|enemy]     starts a definition, it applies to both unless one is named
+//   cooldown <ms>
+//   speed <px/s>
+//   damage <hp>
+//   range <px> | range player [bonus px]
+//   scale <factor>                  size of the bullet relative to the default
+//   muzzle <px>                     the player's shots start this far in front of the player
+//   jitter <degrees>
+//   directions <degrees>...         the volley fires the spread around every direction, default 0
+//   spread <degrees>...             default 0, an empty list fires nothing
+//   ricochet | pierce | spline      spline bullets curve toward the player
+class GunTable
+{
+public:
+	// Replaces the table with the definitions in the file
+	// Returns false after printing the offending line if the file can't be read or parsed
+	bool load(const std::string& path);
+
+	const GunDefinition& get(GUN_ID id, bool fired_by_player) const;
+
+	// Spawns the whole volley of a gun from the position, aimed at the angle
+	// Spline bullets curve toward the target, player_range is the player's range stat
+	void fire(GUN_ID id, vec2 position, float angle, bool shot_by_player, bool shot_by_boss, vec2 target, float player_range) const;
+
+	std::vector<GunShot> shots;
+
+private:
+	GunDefinition definitions[2][gun_definition_count];
+};
+
+extern GunTable gunTable;
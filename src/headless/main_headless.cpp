@@ -0,0 +1,252 @@
+// The simulation still references the GL entry points (gl_has_errors), they are never called
+#define GL3W_IMPLEMENTATION
+#include <gl3w.h>
+
+// stlib
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+// internal
+#include "physics_system.hpp"
+#include "render_system.hpp"
+#include "world_system.hpp"
+#include "ai_system.hpp"
+#include "ui_system.hpp"
+#include "profiler.hpp"
+#include "telemetry.hpp"
+#include "hitch_capture.hpp"
+#include "alloc_tracker.hpp"
+#include "bullet_system.hpp"
+#include "state_hash.hpp"
+#include "rng.hpp"
+#include "gun_table.hpp"
+#include "frame_arena.hpp"
+using Clock = std::chrono::high_resolution_clock;
+
+// Command line options of the headless runner
+struct HeadlessOptions {
+	int frames = 600;
+	float dt_ms = 1000.f / 60.f;
+	int room = -1;
+	unsigned long long seed = 0;
+	std::string scenario;
+	std::string trace;
+	std::string telemetry;
+	std::string hash;
+	float hitch_budget_ms = 0.f;
+	int warmup_frames = 120;
+	long long max_steady_allocs = -1;
+	bool autofire = false;
+	bool through_door = false;
+};
+
+static void print_usage(const char* program) {
+	printf("Usage: %s [--frames N] [--dt MS] [--room TYPE [--through-door] | --scenario FILE] [--autofire] [--trace FILE] [--telemetry FILE] [--hitch-budget MS]\n", program);
+	printf("       [--warmup-frames N] [--max-steady-allocs N] [--hash FILE] [--seed N]\n");
+	printf("  --frames N       number of fixed steps to simulate (default 600)\n");
+	printf("  --dt MS          timestep in milliseconds (default 16.667)\n");
+	printf("  --room TYPE      room to enter first: 0 enemy, 1 shop, 2-4 tutorial, 5 boss (default: first tutorial room)\n");
+	printf("  --through-door   walk into the room through a door, the room is built during the transition like in the game\n");
+	printf("  --scenario FILE  stress test scenario to load instead of a room, see data/scenarios/\n");
+	printf("  --autofire       keep the player's gun firing at the nearest enemy\n");
+	printf("  --trace FILE     write the profile of the last frames as a Chrome trace on exit\n");
+	printf("  --telemetry FILE write frame time percentiles per room type as CSV on exit\n");
+	printf("  --hitch-budget MS write a Chrome trace of the last frames whenever a frame takes longer (default off)\n");
+	printf("  --warmup-frames N frames before the steady state allocation statistics start (default 120)\n");
+	printf("  --max-steady-allocs N fail if a steady state frame makes more heap allocations, needs TRACK_ALLOCATIONS\n");
+	printf("  --seed N         seed of every random stream (default 0), a scenario's seed directive replaces it\n");
+	printf("  --hash FILE      write a hash of the gameplay state after every frame, compare runs with treasuregunner_hashdiff\n");
+}
+
+static bool parse_options(int argc, char* argv[], HeadlessOptions& options) {
+	for (int i = 1; i < argc; i++) {
+		bool has_value = i + 1 < argc;
+		if (strcmp(argv[i], "--frames") == 0 && has_value) {
+			options.frames = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--dt") == 0 && has_value) {
+			options.dt_ms = (float)atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--room") == 0 && has_value) {
+			options.room = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--scenario") == 0 && has_value) {
+			options.scenario = argv[++i];
+		}
+		else if (strcmp(argv[i], "--trace") == 0 && has_value) {
+			options.trace = argv[++i];
+		}
+		else if (strcmp(argv[i], "--telemetry") == 0 && has_value) {
+			options.telemetry = argv[++i];
+		}
+		else if (strcmp(argv[i], "--hitch-budget") == 0 && has_value) {
+			options.hitch_budget_ms = (float)atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--seed") == 0 && has_value) {
+			options.seed = strtoull(argv[++i], nullptr, 10);
+		}
+		else if (strcmp(argv[i], "--hash") == 0 && has_value) {
+			options.hash = argv[++i];
+		}
+		else if (strcmp(argv[i], "--warmup-frames") == 0 && has_value) {
+			options.warmup_frames = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--max-steady-allocs") == 0 && has_value) {
+			options.max_steady_allocs = atoll(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--autofire") == 0) {
+			options.autofire = true;
+		}
+		else if (strcmp(argv[i], "--through-door") == 0) {
+			options.through_door = true;
+		}
+		else {
+			return false;
+		}
+	}
+	return options.frames > 0 && options.dt_ms > 0.f && options.room <= 5 && (options.room < 0 || options.scenario.empty()) && (options.room >= 0 || !options.through_door);
+}
+
+// Points the player at the closest enemy and holds the trigger down
+static void autofire(Entity player) {
+	if (!registry.guns.has(player))
+		return;
+	vec2 player_position = registry.motions.get(player).position;
+	float closest = std::numeric_limits<float>::max();
+	for (Entity enemy : registry.enemies.entities) {
+		if (!registry.motions.has(enemy))
+			continue;
+		vec2 d = registry.motions.get(enemy).position - player_position;
+		float dist2 = dot(d, d);
+		if (dist2 < closest) {
+			closest = dist2;
+			registry.players.get(player).mouse_position = registry.motions.get(enemy).position;
+		}
+	}
+	registry.guns.get(player).is_firing = true;
+}
+
+// Entry point for running the simulation without a window, GPU or audio device
+int main(int argc, char* argv[])
+{
+	HeadlessOptions options;
+	if (!parse_options(argc, argv, options)) {
+		print_usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	// Global systems
+	WorldSystem world_system;
+	RenderSystem render_system;
+	PhysicsSystem physics_system;
+	AISystem ai_system;
+	UISystem ui_system;
+
+	randomService.seed(options.seed);
+
+	// Gun patterns are data, a changed file only needs a restart
+	if (!gunTable.load(data_path() + "/guns.txt"))
+		return EXIT_FAILURE;
+
+	// initialize the main systems, the renderer, UI and sound are no-op sinks
+	render_system.init(nullptr, &ui_system);
+	world_system.init(&render_system, &ui_system);
+	ui_system.init(nullptr);
+
+	if (options.max_steady_allocs >= 0 && !alloc_tracking_enabled()) {
+		printf("--max-steady-allocs needs a build with TREASUREGUNNER_TRACK_ALLOCATIONS=ON\n");
+		return EXIT_FAILURE;
+	}
+	hitchCapture.budget_ms = options.hitch_budget_ms;
+	StateHashRecorder state_hashes;
+	if (!options.hash.empty() && !state_hashes.open(options.hash))
+		return EXIT_FAILURE;
+
+	// Skip the main menu
+	ui_system.exit_state(UI_STATE_ID::MENU);
+	ui_system.enter_state(UI_STATE_ID::PLAYING);
+	if (options.room >= 0 && options.through_door)
+		world_system.start_transition(registry.players.entities[0], 1, options.room);
+	else if (options.room >= 0)
+		world_system.enter_room(1, options.room);
+	if (!options.scenario.empty() && !world_system.load_scenario(options.scenario))
+		return EXIT_FAILURE;
+
+	// Allocations of the frames after the warmup, the room is built and the buffers have grown by then
+	long long steady_frames = 0;
+	long long steady_allocs = 0;
+	long long steady_bytes = 0;
+	ProfileFrame worst_frame;
+
+	// fixed timestep loop
+	auto start = Clock::now();
+	int frame = 0;
+	for (; frame < options.frames && !world_system.is_over(); frame++) {
+		if (options.autofire && registry.players.size() > 0)
+			autofire(registry.players.entities[0]);
+
+		frameArena.reset();
+		profiler.begin_frame();
+		world_system.step(options.dt_ms);
+		physics_system.step(options.dt_ms);
+		ai_system.step(options.dt_ms);
+
+		world_system.handle_collisions();
+
+		render_system.draw();
+		hitchCapture.record_component_counts();
+		profiler.end_frame();
+		hitchCapture.check_last_frame();
+		if (!options.hash.empty())
+			state_hashes.record(frame);
+
+		const ProfileFrame* profiled = profiler.last_frame();
+		telemetry.record_frame((profiled->end_ns - profiled->start_ns) / 1e6f, profiled);
+		if (frame >= options.warmup_frames) {
+			steady_frames++;
+			steady_allocs += profiled->allocs;
+			steady_bytes += profiled->alloc_bytes;
+			if (steady_frames == 1 || profiled->allocs > worst_frame.allocs)
+				worst_frame = *profiled;
+		}
+	}
+	float wall_ms = (float)(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start)).count() / 1000;
+
+	printf("frames: %d\n", frame);
+	printf("simulated time: %.1f ms\n", frame * options.dt_ms);
+	printf("wall time: %.1f ms\n", wall_ms);
+	printf("average: %.4f ms/frame\n", frame > 0 ? wall_ms / frame : 0.f);
+	if (hitchCapture.capture_count > 0)
+		printf("hitches captured: %d\n", hitchCapture.capture_count);
+	printf("motions: %zu, enemies: %zu, projectiles: %zu, enemy bullets: %zu, particle systems: %zu\n",
+		registry.motions.size(), registry.enemies.size(), registry.projectiles.size(), bulletSystem.size(), registry.particleSystems.size());
+	printf("frame arena: %zu bytes at the peak, %zu reserved\n", frameArena.high_water_mark(), frameArena.capacity());
+
+	bool allocs_exceeded = false;
+	if (alloc_tracking_enabled()) {
+		AllocStats total = alloc_stats();
+		printf("heap allocations: %lld (%lld bytes), frees: %lld\n", total.count, total.bytes, total.frees);
+		if (steady_frames > 0) {
+			printf("steady state (%lld frames): %.2f allocations/frame, %.0f bytes/frame, worst frame %lld with %lld allocations\n",
+				steady_frames, (double)steady_allocs / steady_frames, (double)steady_bytes / steady_frames, worst_frame.index, worst_frame.allocs);
+			for (const ProfileZone& zone : worst_frame.zones) {
+				if (zone.allocs > 0)
+					printf("  %*s%-*s %6lld allocations %8lld bytes\n", zone.depth * 2, "", 36 - zone.depth * 2, zone.name, zone.allocs, zone.alloc_bytes);
+			}
+			allocs_exceeded = options.max_steady_allocs >= 0 && worst_frame.allocs > options.max_steady_allocs;
+		}
+		if (allocs_exceeded)
+			printf("FAILED: frame %lld made %lld heap allocations, the limit is %lld\n", worst_frame.index, worst_frame.allocs, options.max_steady_allocs);
+	}
+
+	if (!options.trace.empty() && !profiler.export_chrome_trace(options.trace))
+		return EXIT_FAILURE;
+	if (!options.telemetry.empty() && !telemetry.write_csv(options.telemetry))
+		return EXIT_FAILURE;
+	return allocs_exceeded ? EXIT_FAILURE : EXIT_SUCCESS;
+}
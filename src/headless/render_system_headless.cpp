@@ -0,0 +1,17 @@
+// RenderSystem for the headless build
+// Only provides the state the simulation reads: the screen state and the (default sized) meshes
+#include "render_system.hpp"
+#include "tiny_ecs_registry.hpp"
+
+bool RenderSystem::init(GLFWwindow* window_arg, UISystem* ui_system) {
+	this->window = window_arg;
+	this->ui_system = ui_system;
+	registry.screenStates.emplace(screen_state_entity);
+	return true;
+}
+
+void RenderSystem::draw() {
+}
+
+RenderSystem::~RenderSystem() {
+}
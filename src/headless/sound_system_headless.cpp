@@ -0,0 +1,28 @@
+// Silent SoundSystem for the headless build, every sound is dropped
+#include "sound_system.hpp"
+
+void SoundSystem::loadSFX() {}
+void SoundSystem::playBGM() {}
+void SoundSystem::playBossBGM() {}
+void SoundSystem::playShopBGM() {}
+void SoundSystem::playError() {}
+void SoundSystem::playGlassBreak() {}
+void SoundSystem::playSteps() {}
+void SoundSystem::playCloseDoor() {}
+void SoundSystem::playOpenDoor() {}
+void SoundSystem::playPlayerShoot() {}
+void SoundSystem::playRicochet() {}
+void SoundSystem::playPowerUp() {}
+void SoundSystem::playHeal() {}
+void SoundSystem::playDodge() {}
+void SoundSystem::playPlayerDamage() {}
+void SoundSystem::playPlayerDeath() {}
+void SoundSystem::playEnemyDeath() {}
+void SoundSystem::playEnemyShoot() {}
+void SoundSystem::playEnemyDamage() {}
+void SoundSystem::playBossDeath() {}
+void SoundSystem::playBossRoar() {}
+void SoundSystem::playBossShoot() {}
+void SoundSystem::playBossDamage() {}
+void SoundSystem::playFire() { playingFire = true; }
+void SoundSystem::stopFire() { playingFire = false; }
@@ -0,0 +1,23 @@
+// UISystem for the headless build
+// The UI state is kept (see ui_state.cpp) since the game logic depends on it, nothing is drawn
+#include "ui_system.hpp"
+
+bool UISystem::init(GLFWwindow* window) {
+	this->window = window;
+	return true;
+}
+
+bool UISystem::wants_mouse_input() {
+	return false;
+}
+
+void UISystem::set_textures(std::array<GLuint, texture_count>& textures) {
+	this->textures = textures;
+}
+
+void UISystem::render() {
+	pressed_button = UI_BUTTON_ID::NONE;
+}
+
+UISystem::~UISystem() {
+}
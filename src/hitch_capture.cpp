@@ -0,0 +1,41 @@
+// internal
+#include "hitch_capture.hpp"
+#include "profiler.hpp"
+#include "tiny_ecs_registry.hpp"
+
+// stlib
+#include <ctime>
+#include <typeinfo>
+
+HitchCapture hitchCapture;
+
+void HitchCapture::record_component_counts()
+{
+	if (budget_ms <= 0.f)
+		return;
+	// Same names as registry.list_all_components
+	for (ContainerInterface* container : registry.all_containers())
+		profiler.record_counter(typeid(*container).name(), (long long)container->size());
+}
+
+bool HitchCapture::check_last_frame()
+{
+	const ProfileFrame* frame = profiler.last_frame();
+	if (budget_ms <= 0.f || !frame || frame->index < next_capture_frame)
+		return false;
+	float frame_ms = (frame->end_ns - frame->start_ns) / 1e6f;
+	if (frame_ms <= budget_ms)
+		return false;
+
+	char timestamp[32];
+	std::time_t now = std::time(nullptr);
+	std::strftime(timestamp, sizeof(timestamp), "%Y%m%d-%H%M%S", std::localtime(&now));
+	std::string path = directory + "/hitch_" + timestamp + "_frame" + std::to_string(frame->index) + ".json";
+
+	printf("Frame %lld took %.1f ms (budget %.1f ms)\n", frame->index, frame_ms, budget_ms);
+	next_capture_frame = frame->index + cooldown_frames;
+	if (!profiler.export_chrome_trace(path))
+		return false;
+	capture_count++;
+	return true;
+}
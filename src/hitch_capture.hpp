@@ -0,0 +1,31 @@
+#pragma once
+
+// stlib
+#include <string>
+
+// Saves the profile of the last few seconds whenever a frame takes longer than the budget
+// Each profiled frame also carries the number of components of every type, so room builds and volleys show up in the capture
+class HitchCapture
+{
+public:
+	// Frames slower than this are captured, 0 turns the capture off
+	float budget_ms = 100.f;
+	// Frames to skip after a capture so a run of slow frames only produces one file
+	int cooldown_frames = 120;
+	// Where the captures are written, the file names hold the local time and the frame index
+	std::string directory = ".";
+
+	// Records the component counts as counters of the profiler frame in progress
+	void record_component_counts();
+
+	// Checks the frame the profiler just finished and writes a Chrome trace of the buffered frames if it was too slow
+	// Returns true when a capture was written
+	bool check_last_frame();
+
+	int capture_count = 0;
+
+private:
+	long long next_capture_frame = 0;
+};
+
+extern HitchCapture hitchCapture;
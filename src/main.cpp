@@ -4,6 +4,7 @@
 
 // stlib
 #include <chrono>
+#include <cstdlib>
 
 // internal
 #include "physics_system.hpp"
@@ -11,6 +12,12 @@
 #include "world_system.hpp"
 #include "ai_system.hpp"
 #include "ui_system.hpp"
+#include "profiler.hpp"
+#include "telemetry.hpp"
+#include "hitch_capture.hpp"
+#include "rng.hpp"
+#include "gun_table.hpp"
+#include "frame_arena.hpp"
 using Clock = std::chrono::high_resolution_clock;
 
 // Entry point
@@ -33,6 +40,15 @@ int main()
 		return EXIT_FAILURE;
 	}
 
+	// Every run prints its seed, TREASUREGUNNER_SEED=<n> plays it again
+	const char* seed = getenv("TREASUREGUNNER_SEED");
+	randomService.seed(seed ? strtoull(seed, nullptr, 10) : RandomService::seed_from_device());
+	printf("Random seed: %llu\n", (unsigned long long)randomService.get_seed());
+
+	// Gun patterns are data, a changed file only needs a restart
+	if (!gunTable.load(data_path() + "/guns.txt"))
+		return EXIT_FAILURE;
+
 	// initialize the main systems
 	render_system.init(window, &ui_system);
 	printf("render_system init success!\n");
@@ -41,6 +57,10 @@ int main()
 	ui_system.init(window);
 	printf("ui_system init success!\n");
 
+	// Slow frames are saved as hitch_*.json traces, TREASUREGUNNER_HITCH_BUDGET_MS=0 turns this off
+	if (const char* budget = getenv("TREASUREGUNNER_HITCH_BUDGET_MS"))
+		hitchCapture.budget_ms = (float)atof(budget);
+
 	// Render one frame of the UI system to avoid any flicker on startup
 	ui_system.render();
 
@@ -54,17 +74,24 @@ int main()
 		auto now = Clock::now();
 		float elapsed_ms =
 			(float)(std::chrono::duration_cast<std::chrono::microseconds>(now - t)).count() / 1000;
+		// The previous frame from start to start, with its profiled systems
+		if (profiler.last_frame())
+			telemetry.record_frame(elapsed_ms, profiler.last_frame());
 
 		while (ui_system.in_pause_state()) {
 			glfwPollEvents();
 			render_system.draw();
 			world_system.check_ui();
 			if (glfwWindowShouldClose(window)) {
+				telemetry.write_csv("frame_telemetry.csv");
 				return EXIT_SUCCESS;
 			}
 		}
 
 		t = Clock::now();
+		// Scratch data of the previous frame is dropped
+		frameArena.reset();
+		profiler.begin_frame();
 		world_system.step(elapsed_ms);
 		physics_system.step(elapsed_ms);
 		ai_system.step(elapsed_ms);
@@ -72,7 +99,12 @@ int main()
 		world_system.handle_collisions();
 
 		render_system.draw();
+		hitchCapture.record_component_counts();
+		profiler.end_frame();
+		hitchCapture.check_last_frame();
 	}
 
+	telemetry.write_csv("frame_telemetry.csv");
+	printf("Frame arena high water mark: %zu bytes of %zu\n", frameArena.high_water_mark(), frameArena.capacity());
 	return EXIT_SUCCESS;
 }
@@ -0,0 +1,244 @@
+// internal
+#include "particles.hpp"
+#include "tiny_ecs_registry.hpp"
+#include "profiler.hpp"
+#include "rng.hpp"
+
+#include <glm/trigonometric.hpp>
+#include <vector>
+
+// Particles of the dodge trail that are not in use are parked off screen
+const float INITIAL_DODGE_PARTICLE_POSITION = -100;
+
+// Spread of a spark burst in degrees, filled in one go and kept so the bursts don't allocate
+static std::vector<float> random_angles;
+
+bool stepParticleSystems(float elapsed_ms, Entity player, ScreenState& screen)
+{
+	PROFILE_SCOPE("stepParticleSystems");
+	bool prize_finished = false;
+	RandomStream& random = randomService.stream(RNG_STREAM::PARTICLES);
+	// Iterate backwards to be able to remove without interfering with the next system to visit
+	for (int p = (int)registry.particleSystems.size() - 1; p >= 0; --p) {
+		Entity particle = registry.particleSystems.entities[p];
+		ParticleSystem& particleSystem = registry.particleSystems.components[p];
+
+		if (particleSystem.lifetime < 0) {
+			if (particleSystem.texture == TEXTURE_ASSET_ID::PRIZE && particleSystem.has_spawned) {
+				prize_finished = true;
+			}
+			particleSystem.has_spawned = false;
+			registry.remove_all_components_of(particle);
+		} else {
+			if (particleSystem.texture == TEXTURE_ASSET_ID::SMOKE && registry.dodgeTimers.has(player)) {
+				vec2 relativePosition = registry.dodgeTimers.get(player).initialPosition - registry.dodgeTimers.get(player).finalPosition;
+				vec2 playerMovement = registry.dodgeTimers.get(player).initialPosition - registry.motions.get(player).position;
+				particleSystem.angle = (atan2(relativePosition.x, relativePosition.y)) * 180.0f / M_PI;
+				int foundIndex = -1;
+				for (int i = 0; i < particleSystem.num_particles - 1; i++) {
+					if (particleSystem.particles[i].lifetime <= 0) {
+						particleSystem.particles[i].position.x = INITIAL_DODGE_PARTICLE_POSITION;
+						particleSystem.particles[i].position.y = INITIAL_DODGE_PARTICLE_POSITION;
+					}
+					else if (particleSystem.particles[i].position.x == INITIAL_DODGE_PARTICLE_POSITION && particleSystem.particles[i].position.y == INITIAL_DODGE_PARTICLE_POSITION) {
+						foundIndex = i;
+						particleSystem.particles[i].lifetime = 200.f;
+						break;
+					}
+					else {
+						particleSystem.particles[i].lifetime -= elapsed_ms;
+					}
+				}
+
+
+				if (foundIndex != -1 && playerMovement != vec2(0, 0) && particleSystem.particles[foundIndex].lifetime >= 0) {
+					float incX = relativePosition.x / particleSystem.num_particles;
+					float incY = relativePosition.y / particleSystem.num_particles;
+
+					if (abs(incX * foundIndex) <= abs(playerMovement.x) && abs(incY * foundIndex) <= abs(playerMovement.y)) {
+						particleSystem.particles[foundIndex].position.x = registry.motions.get(player).position.x;
+						particleSystem.particles[foundIndex].position.y = registry.motions.get(player).position.y;
+					}
+				}
+
+				particleSystem.has_spawned = true;
+
+			}
+			// partially used gpt
+			if (particleSystem.texture == TEXTURE_ASSET_ID::DEATH || particleSystem.texture == TEXTURE_ASSET_ID::DEATH_GREEN || particleSystem.texture == TEXTURE_ASSET_ID::DEATH_BLUE || particleSystem.texture == TEXTURE_ASSET_ID::DEATH_BOSS || particleSystem.texture == TEXTURE_ASSET_ID::DEATH_MINE || particleSystem.texture == TEXTURE_ASSET_ID::DEATH_GARBAGE || particleSystem.texture == TEXTURE_ASSET_ID::DEATH_BOMB) {
+				if (!particleSystem.has_spawned) {
+					for (int i = 0; i < particleSystem.num_particles; i++) {
+						particleSystem.particles[i].position.y -= i * 10.f;
+						particleSystem.particles[i].velocity.x = 0.0f;
+						particleSystem.particles[i].velocity.y = -100.0f;
+						particleSystem.particles[i].angle = i * 50.0f;
+					}
+					particleSystem.has_spawned = true;
+				}
+
+				for (int i = 0; i < particleSystem.num_particles; i++) {
+					particleSystem.particles[i].angle += elapsed_ms * 0.4f;
+					float wave = sin(particleSystem.particles[i].angle * (M_PI / 180.0f)) * 80.0f;
+					particleSystem.particles[i].velocity.x = wave;
+
+					particleSystem.particles[i].position += particleSystem.particles[i].velocity * (elapsed_ms / 1000.0f);
+				}
+			}
+
+			if(particleSystem.texture == TEXTURE_ASSET_ID::HEART_PARTICLE)  {
+				if (!particleSystem.has_spawned) {
+					for (int i = 0; i < particleSystem.num_particles; i++) {
+						float angleVariation = random.uniform() * M_PI / 4 - M_PI / 8;
+						float angle = M_PI / 2 + angleVariation; 
+						float speed = 2.f * random.uniform() * 100 + 500;
+						vec2 velocity = {5* speed * cos(angle) * 0.1f, speed * sin(angle)};
+						particleSystem.particles[i].velocity = velocity;
+					};
+					particleSystem.has_spawned = true;
+				}
+				for (int i = 0; i < particleSystem.num_particles; i++) {
+					particleSystem.particles[i].velocity.y += 980.0f * elapsed_ms / 2000.0f; 
+					particleSystem.particles[i].velocity.x *= 0.99f;  // Apply drag
+					particleSystem.particles[i].position += particleSystem.particles[i].velocity * elapsed_ms / 1000.0f;
+
+					// Simple bounce on ground collision, assuming ground is at y = 0
+					vec2 initial_position = particleSystem.init_position;
+					if (particleSystem.particles[i].position.y >= initial_position.y) {
+						particleSystem.particles[i].position.y = initial_position.y;
+						particleSystem.particles[i].velocity.y = -particleSystem.particles[i].velocity.y * 0.7;
+					}
+
+				}
+
+			}
+
+			if(particleSystem.texture == TEXTURE_ASSET_ID::COIN)  {
+				vec2 player_position = registry.motions.get(player).position;
+				if (!particleSystem.has_spawned) {
+					for (int i = 0; i < particleSystem.num_particles; i++) {
+						float random_offset_x = (float)random.range(1, 50);
+						float random_offset_y = (float)random.range(1, 50);
+
+						particleSystem.particles[i].position += vec2(random_offset_x, random_offset_y);
+						vec2 direction_to_player = normalize(player_position - particleSystem.particles[i].position);
+						float speed = 500.0f;
+						particleSystem.particles[i].velocity = direction_to_player * speed;
+					}
+					particleSystem.has_spawned = true;
+				}
+
+				for (int i = 0; i < particleSystem.num_particles; i++) {
+					if (particleSystem.particles[i].lifetime > 0) {
+						vec2 direction_to_player = normalize(player_position - particleSystem.particles[i].position);
+						float distance_to_player = length(player_position - particleSystem.particles[i].position);
+
+						float attraction_strength = 10000.0f;
+						float max_velocity = 500.0f;
+						attraction_strength *= (1.0f - distance_to_player / 10000.0f);
+						particleSystem.particles[i].velocity += direction_to_player * attraction_strength * elapsed_ms / 1000.0f;
+
+						if (length(particleSystem.particles[i].velocity) > max_velocity) {
+							particleSystem.particles[i].velocity = normalize(particleSystem.particles[i].velocity) * max_velocity;
+						}
+
+						particleSystem.particles[i].velocity *= 0.99f;
+
+						particleSystem.particles[i].position += particleSystem.particles[i].velocity * elapsed_ms / 1000.0f;
+						if (distance_to_player < 50.0f) {
+							Player& player = registry.players.components[0];
+							player.coins += 5;
+							particleSystem.particles[i].lifetime = 0.0f;
+						}
+					}
+					else {
+						particleSystem.particles[i].position.x = INITIAL_DODGE_PARTICLE_POSITION;
+						particleSystem.particles[i].position.y = INITIAL_DODGE_PARTICLE_POSITION;
+					}
+				}
+			}
+
+			if (particleSystem.texture == TEXTURE_ASSET_ID::PRIZE) {
+				if (!particleSystem.has_spawned) {
+					for (int i = 0; i < particleSystem.num_particles; i++) {
+						vec2 initial_position = (i % 2 == 0) ? vec2(0, window_height_px) : vec2(window_width_px, window_height_px);
+
+						float angleVariation = random.uniform() * M_PI / 8 - M_PI / 16;
+						float angle = ((i % 2 == 0) ? -M_PI / 3 : -5 * M_PI / 7) + angleVariation;
+						float speed = 1000 + random.uniform() * 500;
+						vec2 velocity = { speed * cos(angle), speed * sin(angle) };
+
+						particleSystem.particles[i].position = initial_position;
+						particleSystem.particles[i].velocity = velocity;
+					};
+					particleSystem.has_spawned = true;
+				}
+				for (int i = 0; i < particleSystem.num_particles; i++) {
+					particleSystem.particles[i].velocity.y += 980.0f * elapsed_ms / 1000.0f;
+					particleSystem.particles[i].position += particleSystem.particles[i].velocity * elapsed_ms / 1000.0f;
+					if (particleSystem.lifetime < 2000) {
+						screen.screen_darken_factor += elapsed_ms / 300000.0f;
+					}
+				}
+			}
+			
+			if (particleSystem.texture == TEXTURE_ASSET_ID::SPARK_BASE) {
+				if (!particleSystem.has_spawned) {
+					vec2 particlePosition = particleSystem.position;
+					vec2 velocity = particleSystem.velocity;
+					// ChatGPT velocity randomization
+					float originalAngle = glm::atan(velocity.y, velocity.x);
+					particleSystem.angle = glm::degrees(originalAngle);
+
+					// Random angles between -30 and +30 degrees
+					random_angles.resize(particleSystem.num_particles);
+					random.fill_uniform(random_angles.data(), particleSystem.num_particles, -30.f, 30.f);
+					for (int i = 0; i < particleSystem.num_particles; i++) {
+						// Add the random angle to the original angle
+						float finalAngle = originalAngle + glm::radians(random_angles[i]);
+						particleSystem.particles[i].velocity = vec2(glm::cos(finalAngle), glm::sin(finalAngle)) * 400.0f;
+						particleSystem.particles[i].angle = finalAngle;
+					}
+					particleSystem.has_spawned = true;
+				}
+
+				for (int i = 0; i < particleSystem.num_particles; i++) {
+					particleSystem.particles[i].velocity.x *= 0.99f;
+					particleSystem.particles[i].velocity.y *= 0.99f;
+					particleSystem.particles[i].position += particleSystem.particles[i].velocity * (elapsed_ms / 1000.0f);
+				}
+			}
+			if (particleSystem.texture == TEXTURE_ASSET_ID::BULLET_DEAD_BASE ||
+				particleSystem.texture == TEXTURE_ASSET_ID::ENEMY_BULLET_DEAD ||
+				particleSystem.texture == TEXTURE_ASSET_ID::SPLINE_BULLET_DEAD ||
+				particleSystem.texture == TEXTURE_ASSET_ID::BULLET_DEAD_ZAPPER)
+			{
+				// This is the same behaviour as sparks but it's creation conditions are different. Leaving both
+				if (!particleSystem.has_spawned) {
+					vec2 particlePosition = particleSystem.position;
+					vec2 velocity = particleSystem.velocity;
+					// ChatGPT velocity randomization
+					float originalAngle = glm::atan(velocity.y, velocity.x);
+					particleSystem.angle = glm::degrees(originalAngle);
+					// Random angles between -15 and +15 degrees
+					random_angles.resize(particleSystem.num_particles);
+					random.fill_uniform(random_angles.data(), particleSystem.num_particles, -15.f, 15.f);
+					for (int i = 0; i < particleSystem.num_particles; i++) {
+						// Add the random angle to the original angle
+						float finalAngle = originalAngle + glm::radians(random_angles[i]);
+						particleSystem.particles[i].velocity = vec2(glm::cos(finalAngle), glm::sin(finalAngle)) * glm::length(velocity);
+						particleSystem.particles[i].angle = finalAngle;
+					}
+					particleSystem.has_spawned = true;
+				}
+
+				for (int i = 0; i < particleSystem.num_particles; i++) {
+					particleSystem.particles[i].velocity.x *= 0.99f;
+					particleSystem.particles[i].velocity.y *= 0.99f;
+					particleSystem.particles[i].position += particleSystem.particles[i].velocity * (elapsed_ms / 1000.0f);
+				}
+			}
+			particleSystem.lifetime -= elapsed_ms;
+		}
+	}
+	return prize_finished;
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include "common.hpp"
+#include "components.hpp"
+#include "tiny_ecs.hpp"
+
+// Spawns, moves and expires the particles of all particle systems
+// The player is used by the dodge trail and the coins, the screen is darkened by the prize shower
+// Returns true when a prize shower has finished
+bool stepParticleSystems(float elapsed_ms, Entity player, ScreenState& screen);
@@ -1,11 +1,14 @@
 // internal
 #include "physics_system.hpp"
 #include "world_init.hpp"
+#include "profiler.hpp"
+#include "bullet_system.hpp"
+#include "spline_arena.hpp"
 
 #include "world_system.hpp"
 
 // helper function
-void add_entity_no_duplicates(std::vector<Entity>& entities, Entity entity) {
+void add_entity_no_duplicates(FrameVector<Entity>& entities, Entity entity) {
 	bool already_added = false;
 	for (Entity e : entities) {
 		if (e == entity) {
@@ -56,6 +59,7 @@ bool obstacleCollides(const Motion& motion1, const Motion& motion2)
 
 void PhysicsSystem::step(float elapsed_ms)
 {
+	PROFILE_SCOPE("PhysicsSystem::step");
 	// Move fish based on how much time has passed, this is to (partially) avoid
 	// having entities move at different speed based on the machine.
 	auto& motion_container = registry.motions;
@@ -67,24 +71,28 @@ void PhysicsSystem::step(float elapsed_ms)
 		float step_seconds = elapsed_ms / 1000.f;
 		if (registry.splineBullets.has(entity)) {
 			SplineBullet& spline = registry.splineBullets.get(entity);
-			if (spline.distance_covered >= spline.total_distance && !spline.last_point_crossed) {
-				int last = spline.points_on_line.size() - 1;
-				float angle = std::atan2(spline.points_on_line[last].y - spline.points_on_line[last - 1].y, spline.points_on_line[last].x - spline.points_on_line[last - 1].x);
-				motion.angle = angle;
-				motion.velocity = vec2(std::cos(angle), std::sin(angle)) * spline.speed;
+			Projectile& projectile = registry.projectiles.get(entity);
+			float step_distance = spline.speed * step_seconds;
+			spline.distance_covered += step_distance;
+			projectile.distance_travelled += step_distance;
+			if (spline.distance_covered < spline.total_distance) {
+				// On the curve the position comes straight from the distance covered
+				SplinePoint point = splineArena.evaluate(spline.curve, spline.distance_covered);
+				motion.position = point.position;
+				motion.angle = point.angle;
+				motion.velocity = point.direction * spline.speed;
+			}
+			else if (!spline.last_point_crossed) {
+				// Past the end it goes on in a straight line
+				SplinePoint end = splineArena.evaluate(spline.curve, spline.total_distance);
+				motion.angle = end.angle;
+				motion.velocity = end.direction * spline.speed;
+				motion.position = end.position + end.direction * (spline.distance_covered - spline.total_distance);
 				spline.last_point_crossed = true;
 			}
-			if (spline.distance_covered < spline.total_distance) {
-				int point_to_use = floor((spline.distance_covered / spline.total_distance) * (spline.points_on_line.size()));
-				float angle = std::atan2(spline.points_on_line[point_to_use].y - motion.position.y, spline.points_on_line[point_to_use].x - motion.position.x);
-				motion.angle = angle;
-				motion.velocity = vec2(std::cos(angle), std::sin(angle)) * spline.speed;	
+			else {
+				motion.position += motion.velocity * step_seconds;
 			}
-			vec2 dist = motion.velocity * step_seconds;
-			motion.position += dist;
-			Projectile& projectile = registry.projectiles.get(entity);
-			projectile.distance_travelled += sqrt(pow(dist.x, 2) + pow(dist.y, 2));
-			spline.distance_covered += sqrt(pow(dist.x, 2) + pow(dist.y, 2));
 
 			if (projectile.distance_travelled > projectile.max_distance) {
 				// Spawn spline shard particle
@@ -212,6 +220,7 @@ void PhysicsSystem::step(float elapsed_ms)
 			}
 		}
 	}
+	bulletSystem.step(elapsed_ms);
 	check_collisions();
 	return;
 }
@@ -220,10 +229,18 @@ void PhysicsSystem::step(float elapsed_ms)
 // Checks for collisions between all collidable entities
 void PhysicsSystem::check_collisions()
 {
+	PROFILE_SCOPE("PhysicsSystem::check_collisions");
 	auto& collision_mesh_container = registry.collisionMeshes;
 	float min_overlap;
 	vec2 overlap_normal;
-	std::vector<Entity> collided_entities;
+	FrameVector<Entity> collided_entities;
+
+	// Categorize every collidable once so that each collision carries the roles of both entities
+	FrameVector<COLLISION_CATEGORY> categories(collision_mesh_container.size());
+	for (size_t i = 0; i < collision_mesh_container.size(); i++) {
+		categories[i] = getCollisionCategory(collision_mesh_container.entities[i]);
+	}
+
 	for (int i = 0; i < collision_mesh_container.size(); i++) {
 		Entity entity_i = collision_mesh_container.entities[i];
 
@@ -242,6 +259,8 @@ void PhysicsSystem::check_collisions()
 					Collision collision = Collision(entity_j);
 					collision.min_overlap = min_overlap;
 					collision.overlap_normal = overlap_normal;
+					collision.category = categories[i];
+					collision.other_category = categories[j];
 					registry.collisions.insert(entity_i, collision, false);
 
 					resolve_collision(entity_i, collision);
@@ -257,14 +276,14 @@ void PhysicsSystem::check_collisions()
 	float max_area = 0.f;
 }
 
-void PhysicsSystem::substep_collisions(std::vector<Entity>& candidates)
+void PhysicsSystem::substep_collisions(FrameVector<Entity>& candidates)
 {
 	float min_overlap;
 	vec2 overlap_normal;
 
 	for (int substep = 0; substep < COLLISION_SUBSTEPS; substep++) {
-		std::vector<Entity> new_candidates;
-		for (int i = 0; i < candidates.size(); i++) {
+		FrameVector<Entity> new_candidates;
+		for (size_t i = 0; i < candidates.size(); i++) {
 			Entity candidate = candidates[i];
 
 			for (int j = 0; j < registry.collisionMeshes.size(); j++) {
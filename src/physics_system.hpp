@@ -5,6 +5,7 @@
 #include "components.hpp"
 #include "tiny_ecs_registry.hpp"
 #include "collisions.hpp"
+#include "frame_arena.hpp"
 
 // The number of substeps to take when checking for collisions
 // A higher number results in more stable collisions, but is less performant
@@ -18,7 +19,8 @@ public:
 
 	void check_collisions();
 
-	void substep_collisions(std::vector<Entity>& candidates);
+	// Scratch vectors come from the frame arena, see frame_arena.hpp
+	void substep_collisions(FrameVector<Entity>& candidates);
 
 	// Resolves a collision by moving the colliding entities apart
 	void resolve_collision(Entity entity1, Collision& collision);
@@ -0,0 +1,137 @@
+// internal
+#include "prefabs.hpp"
+#include "collisions.hpp"
+#include "tiny_ecs_registry.hpp"
+#include "world_init.hpp"
+
+// stlib
+#include <algorithm>
+#include <cassert>
+
+PrefabTable prefabTable;
+
+// What sets the enemy types apart, indexed by ENEMY_ID
+struct EnemyType {
+	float scale;
+	float angle;
+	int row;
+	int num_frames;
+	float speed;
+	float health;
+	float coin_drop;
+	const char* collider;
+	bool is_static;
+	GUN_ID gun;
+	bool is_firing;
+};
+
+const EnemyType enemy_types[enemy_type_count] = {
+	//  scale   angle                row  frames  speed   health  coins   collider                      static  gun                      firing
+	{ 70.f,   (float)M_PI,         4,   4,      100.f,  30.f,   25.f,   "EnemyNeutral-Scaled.obj",    false,  GUN_ID::STRAIGHT_SHOT,   true }, // NORMAL
+	{ 120.f,  (float)M_PI,         15,  4,      100.f,  90.f,   50.f,   "EnemyElite.obj",             false,  GUN_ID::SPLINE_SHOT,     true }, // ELITE
+	{ 110.f,  (float)(-M_PI / 2),  19,  1,      100.f,  100.f,  100.f,  "DummyCollider-Rotated.obj",  true,   GUN_ID::NO_GUN,          false }, // DUMMY
+	{ 90.f,   (float)M_PI,         34,  6,      100.f,  100.f,  75.f,   "ZapperMesh.obj",             false,  GUN_ID::ZAP_SHOT,        true }, // ZAPPER
+	{ 100.f,  (float)M_PI,         36,  2,      200.f,  40.f,   50.f,   "FlamethrowerMesh.obj",       false,  GUN_ID::FIRE_SHOT,       true }, // FLAMETHROWER
+	{ 120.f,  (float)(M_PI / 2),   32,  4,      100.f,  70.f,   30.f,   "BombMesh.obj",               false,  GUN_ID::EXPLOSION_SHOT,  false }, // BOMBER
+};
+
+// Grows the container to fit count more components, at least doubling it so that spawning swarm after swarm doesn't copy it every time
+template <typename Component>
+static void reserve_more(ComponentContainer<Component>& container, size_t count)
+{
+	size_t needed = container.size() + count;
+	size_t capacity = container.components.capacity();
+	if (needed > capacity)
+		container.reserve(std::max(needed, 2 * capacity));
+}
+
+void PrefabTable::init(RenderSystem* renderer)
+{
+	Mesh* sprite = &renderer->getMesh(GEOMETRY_BUFFER_ID::ANIMATED_SPRITE);
+	RenderRequest sprite_request = { TEXTURE_ASSET_ID::SPRITESHEET, EFFECT_ASSET_ID::ANIMATED, GEOMETRY_BUFFER_ID::ANIMATED_SPRITE };
+
+	for (int i = 0; i < enemy_type_count; i++) {
+		const EnemyType& type = enemy_types[i];
+		EnemyPrefab& prefab = enemy_prefabs[i];
+		prefab.mesh = sprite;
+
+		prefab.motion.angle = type.angle;
+		prefab.motion.scale = sprite->original_size * type.scale;
+
+		prefab.animation.frame = 0;
+		prefab.animation.row = type.row;
+		prefab.animation.num_frames = type.num_frames;
+		prefab.animation.speed = type.speed;
+
+		prefab.enemy.id = (ENEMY_ID)i;
+		prefab.enemy.health = type.health;
+		prefab.enemy.max_health = type.health;
+		prefab.enemy.coin_drop = type.coin_drop;
+
+		prefab.collision_mesh = createMeshCollider(prefab.motion.scale, type.collider);
+		prefab.collision_mesh.is_solid = true;
+		prefab.collision_mesh.is_static = type.is_static;
+
+		prefab.render_request = sprite_request;
+
+		prefab.has_gun = type.gun != GUN_ID::NO_GUN;
+		if (prefab.has_gun) {
+			prefab.gun = createGun(type.gun);
+			prefab.gun.is_firing = type.is_firing;
+		}
+		prefab.random_rotation = (ENEMY_ID)i == ENEMY_ID::ZAPPER;
+	}
+
+	Mesh* boss_sprite = &renderer->getMesh(GEOMETRY_BUFFER_ID::BOSS_SPRITE);
+	boss_prefab.mesh = boss_sprite;
+	boss_prefab.motion.angle = M_PI;
+	boss_prefab.motion.scale = boss_sprite->original_size * 500.f;
+	boss_prefab.animation.frame = 0;
+	boss_prefab.animation.row = 4;
+	boss_prefab.animation.num_frames = 4;
+	boss_prefab.animation.speed = 100.f;
+	boss_prefab.collision_mesh = createMeshCollider(boss_prefab.motion.scale, "BossCollider-Triangulated.obj");
+	boss_prefab.collision_mesh.is_solid = true;
+	boss_prefab.collision_mesh.is_static = true;
+	boss_prefab.render_request = { TEXTURE_ASSET_ID::BOSS, EFFECT_ASSET_ID::BOSS_ANIMATE, GEOMETRY_BUFFER_ID::BOSS_SPRITE };
+	boss_prefab.gun = createGun(GUN_ID::SPLIT_SPLINE_SHOT);
+	boss_prefab.gun.is_firing = false;
+
+	item_prefab.mesh = sprite;
+	item_prefab.motion.angle = M_PI;
+	item_prefab.motion.scale = sprite->original_size * 150.f;
+	item_prefab.motion.scale.x *= -1;
+	item_prefab.animation.frame = 0;
+	item_prefab.animation.num_frames = 4;
+	item_prefab.animation.speed = 300.f;
+	item_prefab.collision_mesh = createEllipseCollisionMesh(item_prefab.motion.scale, 3);
+	item_prefab.collision_mesh.is_solid = true;
+	item_prefab.collision_mesh.is_static = true;
+	item_prefab.render_request = sprite_request;
+
+	initialized = true;
+}
+
+const EnemyPrefab& PrefabTable::enemy(ENEMY_ID id) const
+{
+	assert(initialized && "Prefabs used before PrefabTable::init");
+	assert((int)id >= 0 && (int)id < enemy_type_count && "Not an enemy type");
+	return enemy_prefabs[(int)id];
+}
+
+void PrefabTable::reserve_enemies(size_t count)
+{
+	reserve_more(registry.meshPtrs, count);
+	reserve_more(registry.motions, count);
+	reserve_more(registry.animations, count);
+	reserve_more(registry.enemies, count);
+	reserve_more(registry.collisionMeshes, count);
+	reserve_more(registry.guns, count);
+	reserve_more(registry.flockMembers, count);
+
+	unsigned int layer = (unsigned int)RENDER_LAYER_ID::MIDGROUND_FAR;
+	size_t needed = registry.renderRequests.entities[layer].size() + count;
+	size_t capacity = registry.renderRequests.components[layer].capacity();
+	if (needed > capacity)
+		registry.renderRequests.reserve(layer, std::max(needed, 2 * capacity));
+}
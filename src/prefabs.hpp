@@ -0,0 +1,67 @@
+#pragma once
+
+// internal
+#include "common.hpp"
+#include "components.hpp"
+#include "render_system.hpp"
+
+// stlib
+#include <array>
+
+// The components every enemy of one type starts with, the spawn position, velocity and gun timer are filled in when it is created
+struct EnemyPrefab {
+	Mesh* mesh = nullptr;
+	Motion motion;
+	Animation animation = {};
+	Enemy enemy = {};
+	CollisionMesh collision_mesh;
+	RenderRequest render_request;
+	bool has_gun = false;
+	Gun gun = {};
+	// Zappers start at a random angle and spin in a random direction
+	bool random_rotation = false;
+};
+
+// The boss before its health and coin drop are scaled by the coins of the run
+struct BossPrefab {
+	Mesh* mesh = nullptr;
+	Motion motion;
+	Animation animation = {};
+	Boss boss;
+	CollisionMesh collision_mesh;
+	RenderRequest render_request;
+	Gun gun = {};
+};
+
+// What all items share, the sprite row and the item components depend on the item
+struct ItemPrefab {
+	Mesh* mesh = nullptr;
+	Motion motion;
+	Animation animation = {};
+	CollisionMesh collision_mesh;
+	RenderRequest render_request;
+};
+
+// Component bundles for the enemies, the boss and items, built once when the world is initialized
+// Spawning copies a bundle instead of working out the stats and loading the collider again for every entity
+class PrefabTable
+{
+public:
+	// Needs the meshes of the renderer and the guns of the gun table
+	void init(RenderSystem* renderer);
+
+	const EnemyPrefab& enemy(ENEMY_ID id) const;
+	const BossPrefab& boss() const { return boss_prefab; }
+	const ItemPrefab& item() const { return item_prefab; }
+
+	// Makes room for count more enemies in every container an enemy is added to, so a swarm grows them once
+	void reserve_enemies(size_t count);
+
+private:
+	std::array<EnemyPrefab, enemy_type_count> enemy_prefabs;
+	BossPrefab boss_prefab;
+	ItemPrefab item_prefab;
+	bool initialized = false;
+};
+
+extern PrefabTable prefabTable;
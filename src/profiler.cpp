@@ -0,0 +1,106 @@
+// internal
+#include "profiler.hpp"
+#include "alloc_tracker.hpp"
+
+// stlib
+#include <algorithm>
+#include <cstdio>
+
+Profiler profiler;
+
+long long Profiler::now_ns() const
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+void Profiler::begin_frame()
+{
+	ProfileFrame& frame = frames[frame_count % frame_capacity];
+	frame.index = frame_count;
+	frame.start_ns = now_ns();
+	frame.end_ns = frame.start_ns;
+	frame.zones.clear();
+	frame.counters.clear();
+	// Running totals until end_frame turns them into the frame's share
+	AllocStats stats = alloc_stats();
+	frame.allocs = stats.count;
+	frame.alloc_bytes = stats.bytes;
+	depth = 0;
+}
+
+void Profiler::end_frame()
+{
+	ProfileFrame& frame = frames[frame_count % frame_capacity];
+	AllocStats stats = alloc_stats();
+	frame.allocs = stats.count - frame.allocs;
+	frame.alloc_bytes = stats.bytes - frame.alloc_bytes;
+	frame.end_ns = now_ns();
+	frame_count++;
+}
+
+int Profiler::begin_zone(const char* name)
+{
+	std::vector<ProfileZone>& zones = frames[frame_count % frame_capacity].zones;
+	long long now = now_ns();
+	zones.push_back({ name, depth++, now, now, 0, 0 });
+	// Taken after the push_back so growing the zone list isn't charged to the zone
+	AllocStats stats = alloc_stats();
+	zones.back().allocs = stats.count;
+	zones.back().alloc_bytes = stats.bytes;
+	return (int)zones.size() - 1;
+}
+
+void Profiler::end_zone(int zone)
+{
+	std::vector<ProfileZone>& zones = frames[frame_count % frame_capacity].zones;
+	depth--;
+	// Zones opened before begin_frame are dropped with the rest of the slot
+	if (zone < (int)zones.size()) {
+		AllocStats stats = alloc_stats();
+		zones[zone].allocs = stats.count - zones[zone].allocs;
+		zones[zone].alloc_bytes = stats.bytes - zones[zone].alloc_bytes;
+		zones[zone].end_ns = now_ns();
+	}
+}
+
+void Profiler::record_counter(const char* name, long long value)
+{
+	frames[frame_count % frame_capacity].counters.push_back({ name, value });
+}
+
+const ProfileFrame* Profiler::last_frame() const
+{
+	if (frame_count == 0)
+		return nullptr;
+	return &frames[(frame_count - 1) % frame_capacity];
+}
+
+bool Profiler::export_chrome_trace(const std::string& path) const
+{
+	FILE* file = fopen(path.c_str(), "w");
+	if (file == NULL) {
+		printf("Can't write the profile to %s\n", path.c_str());
+		return false;
+	}
+
+	// Complete ("X") events with timestamps in microseconds, oldest frame first
+	fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+	fprintf(file, "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 1, \"args\": {\"name\": \"main\"}}");
+	for (long long i = std::max(0LL, frame_count - frame_capacity); i < frame_count; i++) {
+		const ProfileFrame& frame = frames[i % frame_capacity];
+		fprintf(file, ",\n{\"name\": \"Frame\", \"cat\": \"frame\", \"ph\": \"X\", \"pid\": 1, \"tid\": 1, \"ts\": %.3f, \"dur\": %.3f, \"args\": {\"frame\": %lld, \"allocs\": %lld, \"alloc_bytes\": %lld}}",
+			frame.start_ns / 1000.0, (frame.end_ns - frame.start_ns) / 1000.0, frame.index, frame.allocs, frame.alloc_bytes);
+		for (const ProfileZone& zone : frame.zones) {
+			fprintf(file, ",\n{\"name\": \"%s\", \"cat\": \"zone\", \"ph\": \"X\", \"pid\": 1, \"tid\": 1, \"ts\": %.3f, \"dur\": %.3f, \"args\": {\"allocs\": %lld, \"alloc_bytes\": %lld}}",
+				zone.name, zone.start_ns / 1000.0, (zone.end_ns - zone.start_ns) / 1000.0, zone.allocs, zone.alloc_bytes);
+		}
+		for (const ProfileCounter& counter : frame.counters) {
+			fprintf(file, ",\n{\"name\": \"%s\", \"ph\": \"C\", \"pid\": 1, \"ts\": %.3f, \"args\": {\"value\": %lld}}",
+				counter.name, frame.start_ns / 1000.0, counter.value);
+		}
+	}
+	fprintf(file, "\n]}\n");
+	fclose(file);
+	printf("Profile of %lld frames written to %s\n", std::min(frame_count, (long long)frame_capacity), path.c_str());
+	return true;
+}
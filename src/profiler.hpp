@@ -0,0 +1,88 @@
+#pragma once
+
+// stlib
+#include <array>
+#include <chrono>
+#include <string>
+#include <vector>
+
+// A timed zone, nested zones have a larger depth and lie inside their parent
+// The heap allocations are only counted in TRACK_ALLOCATIONS builds, see alloc_tracker.hpp
+struct ProfileZone {
+	const char* name;
+	int depth;
+	long long start_ns;
+	long long end_ns;
+	long long allocs;
+	long long alloc_bytes;
+};
+
+// A value sampled once per frame, e.g. the number of entities
+struct ProfileCounter {
+	const char* name;
+	long long value;
+};
+
+// The zones recorded during one frame, in the order they were opened
+struct ProfileFrame {
+	long long index = -1;
+	long long start_ns = 0;
+	long long end_ns = 0;
+	long long allocs = 0;
+	long long alloc_bytes = 0;
+	std::vector<ProfileZone> zones;
+	std::vector<ProfileCounter> counters;
+};
+
+// Records nested timing zones into a ring buffer of the most recent frames
+// Zones are only recorded on the main thread. The frame buffers keep their capacity so recording doesn't allocate once warmed up
+// Use PROFILE_SCOPE instead of begin_zone/end_zone so the markers compile out when PROFILER_DISABLED is defined
+class Profiler
+{
+public:
+	static const int frame_capacity = 240;
+
+	void begin_frame();
+	void end_frame();
+
+	// Returns the zone to pass to end_zone
+	int begin_zone(const char* name);
+	void end_zone(int zone);
+
+	// The name must outlive the recording, like the zone names
+	void record_counter(const char* name, long long value);
+
+	// The most recently completed frame, nullptr before the first frame ends
+	const ProfileFrame* last_frame() const;
+
+	// Writes the buffered frames as Chrome trace_event JSON, it can be opened in chrome://tracing or Perfetto
+	// Counters become counter tracks, allocation counts are attached to the frames and zones as arguments
+	bool export_chrome_trace(const std::string& path) const;
+
+	// Nanoseconds since the profiler was created
+	long long now_ns() const;
+
+private:
+	std::array<ProfileFrame, frame_capacity> frames;
+	long long frame_count = 0;
+	int depth = 0;
+	std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+};
+
+extern Profiler profiler;
+
+// Times the enclosing scope as a zone of the current frame
+struct ProfileScope {
+	int zone;
+	ProfileScope(const char* name) : zone(profiler.begin_zone(name)) {}
+	~ProfileScope() { profiler.end_zone(zone); }
+};
+
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+
+#ifndef PROFILER_DISABLED
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profile_scope_, __LINE__)(name)
+#else
+#define PROFILE_SCOPE(name)
+#endif
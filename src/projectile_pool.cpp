@@ -0,0 +1,16 @@
+// internal
+#include "projectile_pool.hpp"
+#include "tiny_ecs_registry.hpp"
+
+ProjectilePool projectilePool;
+
+void ProjectilePool::reserve(size_t count)
+{
+	registry.motions.reserve(registry.motions.size() + count);
+	registry.collisionMeshes.reserve(registry.collisionMeshes.size() + count);
+	registry.collisionCache.reserve(registry.collisionCache.size() + count);
+	registry.projectiles.reserve(registry.projectiles.size() + count);
+	registry.splineBullets.reserve(registry.splineBullets.size() + count);
+	registry.glows.reserve(registry.glows.size() + count);
+	registry.renderRequests.reserve((unsigned int)RENDER_LAYER_ID::FOREGROUND, registry.renderRequests.entities[(int)RENDER_LAYER_ID::FOREGROUND].size() + count);
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+// internal
+#include "common.hpp"
+#include "components.hpp"
+#include "tiny_ecs.hpp"
+
+// Sizes the bullet components up front so spawning and destroying bullets doesn't allocate
+// The collision meshes, collision cache vertices and hit lists of bullets are small vectors stored inline in the components,
+// together with reserve() and the recycling entity maps a bullet doesn't touch the heap once the containers are warm
+class ProjectilePool
+{
+public:
+	// Makes room in the bullet components for count more entities
+	void reserve(size_t count);
+};
+
+extern ProjectilePool projectilePool;
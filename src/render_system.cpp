@@ -3,6 +3,8 @@
 #include <SDL.h>
 #include <vector>
 #include "tiny_ecs_registry.hpp"
+#include "profiler.hpp"
+#include "bullet_system.hpp"
 
 void RenderSystem::drawTexturedMesh(RenderRequest& render, Motion& motion, Entity entity,
 	const mat3& projection)
@@ -332,6 +334,83 @@ void RenderSystem::drawParticleSystem(const mat3& projection, ParticleSystem& pa
 	gl_has_errors();
 }
 
+void RenderSystem::drawBullets(const mat3& projection)
+{
+	size_t bulletCount = bulletSystem.size();
+	if (bulletCount == 0)
+		return;
+
+	// Group the bullets by style so every style is one contiguous range of the buffer
+	const int floatsPerBullet = 3;
+	std::array<int, bullet_style_count + 1> styleStart;
+	styleStart.fill(0);
+	for (size_t i = 0; i < bulletCount; i++)
+		styleStart[(int)bulletSystem.style[i] + 1]++;
+	for (int style = 1; style <= bullet_style_count; style++)
+		styleStart[style] += styleStart[style - 1];
+	std::array<int, bullet_style_count> styleFill;
+	std::copy(styleStart.begin(), styleStart.begin() + bullet_style_count, styleFill.begin());
+
+	bulletVertices.resize(bulletCount * floatsPerBullet);
+	for (size_t i = 0; i < bulletCount; i++) {
+		float* vertex = &bulletVertices[styleFill[(int)bulletSystem.style[i]]++ * floatsPerBullet];
+		vertex[0] = bulletSystem.position_x[i];
+		vertex[1] = bulletSystem.position_y[i];
+		vertex[2] = bulletSystem.angle[i];
+	}
+
+	// Orphan the old storage so the upload doesn't wait for the previous frame
+	glBindBuffer(GL_ARRAY_BUFFER, bulletVBO);
+	glBufferData(GL_ARRAY_BUFFER, bulletVertices.size() * sizeof(float), nullptr, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, bulletVertices.size() * sizeof(float), bulletVertices.data());
+	gl_has_errors();
+
+	const GLuint program = (GLuint)effects[(GLuint)EFFECT_ASSET_ID::BULLET];
+	glUseProgram(program);
+
+	GLuint projection_loc = glGetUniformLocation(program, "projection");
+	glUniformMatrix3fv(projection_loc, 1, GL_FALSE, (float*)&projection);
+	GLint pointSizeLoc = glGetUniformLocation(program, "pointSize");
+	glUniform1i(glGetUniformLocation(program, "base"), 0); // Texture Unit 0
+	glUniform1i(glGetUniformLocation(program, "samplerGlow"), 1); // Texture Unit 1
+	gl_has_errors();
+
+	GLint posAttrib = glGetAttribLocation(program, "in_position");
+	GLint angleAttrib = glGetAttribLocation(program, "in_angle");
+	glEnableVertexAttribArray(posAttrib);
+	glVertexAttribPointer(posAttrib, 2, GL_FLOAT, GL_FALSE, floatsPerBullet * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(angleAttrib);
+	glVertexAttribPointer(angleAttrib, 1, GL_FLOAT, GL_FALSE, floatsPerBullet * sizeof(float), (void*)(2 * sizeof(float)));
+	gl_has_errors();
+
+	glEnable(GL_PROGRAM_POINT_SIZE);
+	for (int style = 0; style < bullet_style_count; style++) {
+		int count = styleStart[style + 1] - styleStart[style];
+		if (count == 0)
+			continue;
+		const BulletStyle& bulletStyle = bullet_styles[style];
+
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, texture_gl_handles[(GLuint)bulletStyle.texture_base]);
+		glActiveTexture(GL_TEXTURE1);
+		glBindTexture(GL_TEXTURE_2D, texture_gl_handles[(GLuint)bulletStyle.texture_glow]);
+
+		// The point covers the sprite at any rotation
+		glUniform1f(pointSizeLoc, bulletStyle.scale * sqrt(2.f) * resolutionScale);
+		glDrawArrays(GL_POINTS, styleStart[style], count);
+		gl_has_errors();
+	}
+
+	// CLEANUP
+	glDisableVertexAttribArray(angleAttrib);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	gl_has_errors();
+}
+
 void RenderSystem::blurBloom()
 {
 	// Bloom https://www.youtube.com/watch?v=um9iCPUGyU4&ab_channel=VictorGordan
@@ -461,6 +540,7 @@ void RenderSystem::drawToScreen()
 // http://www.opengl-tutorial.org/intermediate-tutorials/tutorial-14-render-to-texture/
 void RenderSystem::draw()
 {
+	PROFILE_SCOPE("RenderSystem::draw");
 	// Getting size of window
 	int w, h;
 	glfwGetFramebufferSize(window, &w, &h); // Note, this will be 2x the resolution given to glfwCreateWindow on retina displays
@@ -490,6 +570,9 @@ void RenderSystem::draw()
 	// Draw all textured meshes that have a position and size component
 	for (int layer = (int)RENDER_LAYER_ID::BACKGROUND_FAR; layer < render_layer_count; layer++)
 	{
+		// Enemy and boss bullets are drawn on top of the foreground, like the bullet entities
+		if (layer == (int)RENDER_LAYER_ID::UI)
+			drawBullets(projection_2D);
 		for (int i = 0, count = registry.renderRequests.components[layer].size(); i < count; i++)
 		{
 			RenderRequest& renderer = registry.renderRequests.components[layer][i];
@@ -127,7 +127,8 @@ class RenderSystem {
 		shader_path("blur"),
 		shader_path("textured-glow"),
 		shader_path("animated"),
-		shader_path("boss")};
+		shader_path("boss"),
+		shader_path("bullet")};
 
 	const std::vector< std::pair<GEOMETRY_BUFFER_ID, std::string>> mesh_paths = {
 		// There are none
@@ -172,6 +173,8 @@ private:
 		const mat3& projection);
 
 	void drawParticleSystem(const mat3& projection, ParticleSystem& particleSystem);
+	// Draws the bullets of the bullet system as point sprites, one upload and one draw call per bullet style
+	void drawBullets(const mat3& projection);
 	void blurBloom();
 	void drawToScreen();
 
@@ -190,7 +193,7 @@ private:
 
 	GLuint off_screen_render_buffer_depth;
 
-	Entity screen_state_entity;
+	Entity screen_state_entity = Entity(ENTITY_SCOPE::PERSISTENT);
 
 	// Absolute max particles = 512
 	const int maxParticles = MAX_PARTICLES;
@@ -200,6 +203,10 @@ private:
 	std::vector<ParticleGLDetails> particleBufferPool;
 	int particleBufferIndex;
 
+	// Position and angle of every bullet, grouped by style, re-uploaded every frame
+	GLuint bulletVBO;
+	std::vector<float> bulletVertices;
+
 	// GLOBAL VAO
 	GLuint globalVAO;
 };
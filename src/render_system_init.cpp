@@ -137,6 +137,10 @@ void RenderSystem::initializeGlTextures()
 	}
 
 	gl_has_errors();
+
+	// Bullet buffer, refilled every frame by drawBullets
+	glGenBuffers(1, &bulletVBO);
+	gl_has_errors();
 }
 
 void RenderSystem::initializeGlEffects()
@@ -283,6 +287,7 @@ RenderSystem::~RenderSystem()
 	// but it's polite to clean after yourself.
 	glDeleteBuffers((GLsizei)vertex_buffers.size(), vertex_buffers.data());
 	glDeleteBuffers((GLsizei)index_buffers.size(), index_buffers.data());
+	glDeleteBuffers(1, &bulletVBO);
 	glDeleteTextures((GLsizei)texture_gl_handles.size(), texture_gl_handles.data());
 	glDeleteTextures(1, &off_screen_render_buffer_color);
 	glDeleteRenderbuffers(1, &off_screen_render_buffer_depth);
@@ -0,0 +1,77 @@
+// internal
+#include "rng.hpp"
+
+// stlib
+#include <random>
+
+RandomService randomService;
+
+void RandomStream::seed(uint64_t seed, uint64_t stream_id)
+{
+	state = 0;
+	increment = (stream_id << 1u) | 1u;
+	next();
+	state += seed;
+	next();
+}
+
+uint32_t RandomStream::next()
+{
+	uint64_t old_state = state;
+	state = old_state * 6364136223846793005ULL + increment;
+	uint32_t xorshifted = (uint32_t)(((old_state >> 18u) ^ old_state) >> 27u);
+	uint32_t rotation = (uint32_t)(old_state >> 59u);
+	return (xorshifted >> rotation) | (xorshifted << ((-rotation) & 31));
+}
+
+float RandomStream::uniform()
+{
+	// The top 24 bits fill the float mantissa exactly
+	return (next() >> 8) * (1.f / 16777216.f);
+}
+
+float RandomStream::uniform(float min, float max)
+{
+	return min + (max - min) * uniform();
+}
+
+double RandomStream::uniform_double(double min, double max)
+{
+	// 53 random bits, drawn in sequence so the order doesn't depend on the compiler
+	uint64_t high = next();
+	uint64_t low = next();
+	uint64_t bits = (high << 21) ^ (low >> 11);
+	return min + (max - min) * (bits * (1.0 / 9007199254740992.0));
+}
+
+int RandomStream::range(int min, int max)
+{
+	// Lemire's multiply and shift, the bias is at most 2^-32 for the small ranges used by the game
+	uint32_t count = (uint32_t)(max - min) + 1;
+	return min + (int)(((uint64_t)next() * count) >> 32);
+}
+
+void RandomStream::fill_uniform(float* out, int count, float min, float max)
+{
+	float scale = (max - min) * (1.f / 16777216.f);
+	for (int i = 0; i < count; i++)
+		out[i] = min + (next() >> 8) * scale;
+}
+
+RandomService::RandomService()
+{
+	seed(0);
+}
+
+void RandomService::seed(uint64_t seed)
+{
+	current_seed = seed;
+	for (int i = 0; i < rng_stream_count; i++)
+		streams[i].seed(seed, i);
+}
+
+uint64_t RandomService::seed_from_device()
+{
+	std::random_device device;
+	return ((uint64_t)device() << 32) | device();
+}
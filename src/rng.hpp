@@ -0,0 +1,62 @@
+#pragma once
+
+// stlib
+#include <array>
+#include <cstdint>
+
+// Independent random streams, one per subsystem so extra draws in one of them don't shift the others
+enum class RNG_STREAM {
+	WORLD = 0,
+	GUNS = WORLD + 1,
+	SPAWNS = GUNS + 1,
+	ROOMS = SPAWNS + 1,
+	PARTICLES = ROOMS + 1,
+	RNG_STREAM_COUNT = PARTICLES + 1
+};
+const int rng_stream_count = (int)RNG_STREAM::RNG_STREAM_COUNT;
+
+// PCG32 (pcg-random.org): 16 bytes of state, the stream id picks one of 2^63 distinct sequences
+// Draws are computed by hand instead of with the <random> distributions, whose results differ between standard libraries
+class RandomStream
+{
+public:
+	void seed(uint64_t seed, uint64_t stream_id);
+
+	uint32_t next();
+
+	// Uniform in [0, 1)
+	float uniform();
+	// Uniform in [min, max)
+	float uniform(float min, float max);
+	double uniform_double(double min, double max);
+	// Uniform integer in [min, max]
+	int range(int min, int max);
+	// Fills out[0..count) with uniform floats in [min, max), e.g. the spread of a particle burst
+	void fill_uniform(float* out, int count, float min, float max);
+
+private:
+	uint64_t state = 0;
+	uint64_t increment = 1;
+};
+
+// Every random decision of the simulation draws from here, so a run is reproduced by its seed
+class RandomService
+{
+public:
+	RandomService();
+
+	// Restarts every stream from the seed
+	void seed(uint64_t seed);
+	uint64_t get_seed() const { return current_seed; }
+
+	RandomStream& stream(RNG_STREAM id) { return streams[(int)id]; }
+
+	// A fresh seed from std::random_device for runs that don't need to be reproduced
+	static uint64_t seed_from_device();
+
+private:
+	uint64_t current_seed = 0;
+	std::array<RandomStream, rng_stream_count> streams;
+};
+
+extern RandomService randomService;
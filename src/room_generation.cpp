@@ -2,6 +2,14 @@
 #include <world_init.hpp>
 #include "tiny_ecs_registry.hpp"
 #include "collisions.hpp"
+#include "rng.hpp"
+#include "spawn_queue.hpp"
+#include "profiler.hpp"
+
+// stlib
+#include <algorithm>
+#include <cassert>
+#include <iterator>
 
 void createBoundaryWalls(RenderSystem* renderer)
 {
@@ -354,19 +362,57 @@ Entity createMovingWall(RenderSystem* renderer, vec2 start_pos, vec2 end_pos, fl
 	return entity;
 }
 
-void createEnemyRoom(RenderSystem* renderer, Entity player, int from) {
-	createFloor(renderer, { window_width_px / 2, window_height_px / 2 }, window_width_px, window_height_px);
+RoomInputs roomInputs(Entity player) {
+	Player& playerRef = registry.players.get(player);
+	RoomInputs inputs;
+	inputs.coins = playerRef.coins;
+	inputs.rooms_cleared = playerRef.roomsCleared;
+	inputs.owned_guns[0] = registry.hasBounces.has(player);
+	inputs.owned_guns[1] = registry.hasSplits.has(player);
+	inputs.owned_guns[2] = registry.hasLongs.has(player);
+	inputs.owned_guns[3] = registry.hasRapids.has(player);
+	return inputs;
+}
 
-	createBoundaryWalls(renderer);
+bool operator==(const RoomInputs& a, const RoomInputs& b) {
+	return a.coins == b.coins && a.rooms_cleared == b.rooms_cleared &&
+		std::equal(std::begin(a.owned_guns), std::end(a.owned_guns), std::begin(b.owned_guns));
+}
+
+bool operator!=(const RoomInputs& a, const RoomInputs& b) {
+	return !(a == b);
+}
+
+// The guns the shop sells, in the order of RoomInputs::owned_guns
+const GUN_ID shop_guns[4] = { GUN_ID::BOUNCING_SHOT, GUN_ID::SPLIT_SHOT, GUN_ID::LONG_SHOT, GUN_ID::RAPID_SHOT };
+
+// Doors on every wall but the one the player came through, the first of them leads to the boss after ten rooms
+static void planDoors(RoomDescriptor& room, RandomStream& random, bool random_types) {
+	bool createBossDoor = room.inputs.rooms_cleared >= 10;
+
+	for (int i = 0; i < 4; i++) {
+		room.door_types[i] = -1;
+		if (i != (room.from + 2) % 4) {
+			if (createBossDoor) {
+				room.door_types[i] = 5;
+				createBossDoor = false;
+			}
+			else {
+				room.door_types[i] = random_types ? random.range(0, 2) % 2 : 0;
+			}
+		}
+	}
+}
+
+static void planEnemyRoom(RoomDescriptor& room, RandomStream& random, RandomStream& spawns) {
+	for (int i = 0; i < 4; i++)
+		room.wall_has_door[i] = true;
 
 	int min = 4;
 	int max = 8;
-	
-	Player& playerRef = registry.players.get(player);
-	int coins = playerRef.coins;
-	int roomsCleared = playerRef.roomsCleared;
 
-	printf("Rooms cleared %d\n", roomsCleared);
+	int coins = room.inputs.coins;
+	int roomsCleared = room.inputs.rooms_cleared;
 
 	int count = coins / 70;
 	if (count < min)
@@ -378,7 +424,7 @@ void createEnemyRoom(RenderSystem* renderer, Entity player, int from) {
 	vec2 spawnMin = {500,500};
 	vec2 spawnMax = {700,700 };
 
-	switch (from) {
+	switch (room.from) {
 		case 0:
 			spawnMin = {350, 350};
 			spawnMax = { window_width_px - 350, window_height_px/2};
@@ -399,8 +445,8 @@ void createEnemyRoom(RenderSystem* renderer, Entity player, int from) {
 
 	if (roomsCleared == 0)
 	{
-		count = rand() % 2 + 3;
-		createEasySwarm(renderer, player, spawnMin, spawnMax, count, false);
+		count = random.range(0, 1) + 3;
+		planEasySwarm(spawns, spawnMin, spawnMax, count, 0, room.enemies);
 	}
 	else if (roomsCleared == 1 || (coins < 50 && roomsCleared > 2)) // Guarentees the first room is easy
 	{
@@ -408,25 +454,25 @@ void createEnemyRoom(RenderSystem* renderer, Entity player, int from) {
 		count = 4;
 		if (roomsCleared > 1)
 		{
-			count += rand() % 4;
+			count += random.range(0, 3);
 		}
 		maxElite = 2;
-		createSwarm(renderer, player, spawnMin, spawnMax, count, maxElite, false);
+		planSwarm(spawns, spawnMin, spawnMax, count, maxElite, 0, room.enemies);
 	}
 	else if (roomsCleared == 2) // The second room will have some spice
 	{
 		//creating normal enemies
 		count = 3;
 		maxElite = 2;
-		createSwarm(renderer, player, spawnMin, spawnMax, count, maxElite, false);
-		int enemyType = rand() % 2;
+		planSwarm(spawns, spawnMin, spawnMax, count, maxElite, 0, room.enemies);
+		int enemyType = random.range(0, 1);
 		if (enemyType == 0)
 		{
-			createFlameThrowerSwarm(renderer, player, spawnMin, spawnMax, 2, false);
+			planFlameThrowerSwarm(spawns, spawnMin, spawnMax, 2, 1, room.enemies);
 		}
 		else if (enemyType == 1)
 		{
-			createBombers(renderer, player, spawnMin, spawnMax, count, false);
+			planBombers(spawns, spawnMin, spawnMax, count, room.enemies);
 		}
 	}
 	else // Base generation for all other rooms
@@ -436,21 +482,7 @@ void createEnemyRoom(RenderSystem* renderer, Entity player, int from) {
 		{
 			createZapperSwarm(renderer, player, spawnMin, spawnMax, 2, false);
 		}*/
-		//creating all enemies
-		/*min = 5;
-		max = 8;
-		count = coins / 70;
-		if (count < min)
-			count = min;
-		if (count > max)
-			count = max;
-
-		maxElite = count - (rand() % 3 + 1);
-		if (maxElite > 4) {
-			maxElite = 4;
-		}*/
-		printf("Mega Swarm\n");
-		createMegaSwarm(renderer, player, spawnMin, spawnMax, coins, roomsCleared, false);
+		planMegaSwarm(spawns, spawnMin, spawnMax, coins, roomsCleared, 0, room.enemies);
 	}
 
 	vec2 wallStartPositions[5] = { 
@@ -477,29 +509,119 @@ void createEnemyRoom(RenderSystem* renderer, Entity player, int from) {
 
 	if (roomsCleared > 2)
 	{
-		if (rand() % 3 == 1) {
-			int pos = rand() % 5;
-			createMovingWall(renderer, wallStartPositions[pos], wallEndPositions[pos], wallTime[pos], 100, 100);
+		if (random.range(0, 2) == 1) {
+			int pos = random.range(0, 4);
+			room.has_moving_wall = true;
+			room.wall_start = wallStartPositions[pos];
+			room.wall_end = wallEndPositions[pos];
+			room.wall_period_ms = wallTime[pos];
 		}
 	}
 
-	bool createBossDoor = false;
-	Player& playerComponent = registry.players.components[0];
+	planDoors(room, random, true);
+}
+
+static void planShopRoom(RoomDescriptor& room, RandomStream& random) {
+	for (int i = 0; i < 4; i++)
+		room.wall_has_door[i] = true;
+	planDoors(room, random, false);
+
+	room.items.push_back({ { (float)window_width_px / 2 - 350.f, (float)window_height_px / 2 }, ITEM_ID::HEALTH, GUN_ID::NO_GUN });
+	room.items.push_back({ { (float)window_width_px / 2, (float)window_height_px / 2 }, ITEM_ID::RANGE, GUN_ID::NO_GUN });
 
-	if (playerComponent.roomsCleared >= 10) {
-		createBossDoor = true;
+	GUN_ID ids[4];
+	int id_count = 0;
+	for (int i = 0; i < 4; i++) {
+		if (!room.inputs.owned_guns[i])
+			ids[id_count++] = shop_guns[i];
 	}
 
+	ITEM_ID item_id;
+	GUN_ID gun_id;
+
+	if (id_count == 0) {
+		item_id = ITEM_ID::RANGE;
+		gun_id = GUN_ID::NO_GUN;
+	}
+	else {
+		int random_number = random.range(0, id_count - 1);
+
+		item_id = ITEM_ID::GUN;
+		gun_id = ids[random_number];
+	}
+
+	room.items.push_back({ { (float)window_width_px / 2 + 350.f, (float)window_height_px / 2 }, item_id, gun_id });
+}
+
+static void planBossRoom(RoomDescriptor& room) {
 	for (int i = 0; i < 4; i++) {
-		if (i != (from + 2) % 4)
-			if (createBossDoor) {
-				createDoor(renderer, i, 5);
-				createBossDoor = false;
-			}
-			else {
-				createDoor(renderer, i, rand() % 3 % 2);
-			}
+		room.wall_has_door[i] = i == (room.from + 2) % 4;
+		room.door_types[i] = -1;
+	}
+	room.has_boss = true;
+	room.boss_coins = room.inputs.coins;
+}
+
+void planRoom(RoomDescriptor& room, int type, int from, const RoomInputs& inputs, RandomStream& random, RandomStream& spawns) {
+	room = RoomDescriptor();
+	room.type = type;
+	room.from = from;
+	room.inputs = inputs;
+	switch (type) {
+	case 0:
+		planEnemyRoom(room, random, spawns);
+		break;
+	case 1:
+		planShopRoom(room, random);
+		break;
+	case 5:
+		planBossRoom(room);
+		break;
+	default:
+		assert(false && "Only enemy, shop and boss rooms are planned");
+	}
+}
+
+void buildRoom(RenderSystem* renderer, Entity player, const RoomDescriptor& room) {
+	PROFILE_SCOPE("buildRoom");
+	createFloor(renderer, { window_width_px / 2, window_height_px / 2 }, window_width_px, window_height_px);
+
+	for (int i = 0; i < 4; i++)
+		createBoundaryWall(renderer, i, room.wall_has_door[i]);
+
+	spawnPlannedEnemies(renderer, player, room.enemies);
+
+	if (room.has_moving_wall) {
+		vec2 start = room.wall_start;
+		vec2 end = room.wall_end;
+		float period_ms = room.wall_period_ms;
+		spawnQueue.push([=]() { createMovingWall(renderer, start, end, period_ms, 100, 100); });
 	}
+
+	for (int i = 0; i < 4; i++) {
+		if (room.door_types[i] >= 0)
+			createDoor(renderer, i, room.door_types[i]);
+	}
+
+	for (const PlannedItem& item : room.items)
+		spawnQueue.push([=]() { createItem(renderer, item.position, item.item_id, item.gun_id, false); });
+
+	if (room.has_boss) {
+		int coins = room.boss_coins;
+		spawnQueue.push([=]() { createBoss(renderer, vec2(window_width_px - 500.f, window_height_px / 2), vec2(0.f, 0.f), coins); });
+	}
+}
+
+// Plans the room from the global streams and builds it, for rooms that weren't planned ahead
+static void createPlannedRoom(RenderSystem* renderer, Entity player, int from, int type) {
+	RoomDescriptor room;
+	planRoom(room, type, from, roomInputs(player), randomService.stream(RNG_STREAM::ROOMS), randomService.stream(RNG_STREAM::SPAWNS));
+	buildRoom(renderer, player, room);
+}
+
+void createEnemyRoom(RenderSystem* renderer, Entity player, int from) {
+	printf("Rooms cleared %d\n", registry.players.get(player).roomsCleared);
+	createPlannedRoom(renderer, player, from, 0);
 }
 
 void createLastRoom(RenderSystem* renderer, Entity player, int from, int* doors, int num_items, vec2* positions, ITEM_ID* item_ids, GUN_ID* gun_ids, bool* shatters) {
@@ -526,65 +648,7 @@ void createLastRoom(RenderSystem* renderer, Entity player, int from, int* doors,
 }
 
 void createShopRoom(RenderSystem* renderer, Entity player, int from) {
-
-	createFloor(renderer, { window_width_px / 2, window_height_px / 2 }, window_width_px, window_height_px);
-
-	createBoundaryWalls(renderer);
-	bool createBossDoor = false;
-	Player& playerComponent = registry.players.components[0];
-
-	if (playerComponent.roomsCleared >= 10) {
-		createBossDoor = true;
-	}
-
-	for (int i = 0; i < 4; i++) {
-		if (i != (from + 2) % 4) {
-			if (createBossDoor) {
-				createDoor(renderer, i, 5);
-				createBossDoor = false;
-			}
-			else {
-				Entity door = createDoor(renderer, i, 0);
-			}
-		}
-	}
-
-	createItem(renderer, { (float)window_width_px / 2 - 350.f, (float)window_height_px / 2 }, ITEM_ID::HEALTH, GUN_ID::NO_GUN, false);
-	createItem(renderer, { (float)window_width_px / 2, (float)window_height_px / 2 }, ITEM_ID::RANGE, GUN_ID::NO_GUN, false);
-
-	std::vector<GUN_ID> ids;
-
-	if (!registry.hasBounces.has(player)) {
-		ids.push_back(GUN_ID::BOUNCING_SHOT);
-	}
-	if (!registry.hasSplits.has(player)) {
-		ids.push_back(GUN_ID::SPLIT_SHOT);
-	}
-	if (!registry.hasLongs.has(player)) {
-		ids.push_back(GUN_ID::LONG_SHOT);
-	}
-	if (!registry.hasRapids.has(player)) {
-		ids.push_back(GUN_ID::RAPID_SHOT);
-	}
-
-	ITEM_ID item_id;
-	GUN_ID gun_id;
-
-	if (ids.size() == 0) {
-		item_id = ITEM_ID::RANGE;
-		gun_id = GUN_ID::NO_GUN;
-	}
-	else {
-		std::random_device rd;
-		std::mt19937 gen(rd());
-		std::uniform_int_distribution<int> distribution(0, ids.size() - 1);
-		int random_number = distribution(gen);
-
-		item_id = ITEM_ID::GUN;
-		gun_id = ids[random_number];
-	}
-
-	createItem(renderer, { (float)window_width_px / 2 + 350.f, (float)window_height_px / 2 }, item_id, gun_id, false);
+	createPlannedRoom(renderer, player, from, 1);
 }
 
 void createTutorialRoomOne(RenderSystem* renderer, Entity player) {
@@ -641,11 +705,6 @@ void createTutorialRoomThree(RenderSystem* renderer, Entity player) {
 }
 
 void createTutorialRoomFour(RenderSystem* renderer, Entity player) {
-	std::random_device rd;
-	std::mt19937 gen(rd());
-	std::uniform_int_distribution<int> distribution(1, 5);
-	int random_number = distribution(gen);
-
 	createFloor(renderer, { window_width_px / 2, window_height_px / 2 }, window_width_px, window_height_px);
 	Entity message = Entity();
 	Motion& motion = registry.motions.emplace(message);
@@ -663,16 +722,5 @@ void createTutorialRoomFour(RenderSystem* renderer, Entity player) {
 }
 
 void createBossRoom(RenderSystem* renderer, Entity player, int from) {
-	createFloor(renderer, { window_width_px / 2, window_height_px / 2 }, window_width_px, window_height_px);
-
-	for (int i = 0; i < 4; i++) {
-		if (i==(from+2)%4)
-			createBoundaryWall(renderer, i, 1);
-		else
-			createBoundaryWall(renderer, i, 0);
-	}
-
-	auto entity = createBoss(renderer, vec2(window_width_px - 500.f, window_height_px / 2), vec2(0.f, 0.f), registry.players.get(player).coins);
-	
-	
-}
\ No newline at end of file
+	createPlannedRoom(renderer, player, from, 5);
+}
@@ -4,6 +4,54 @@
 #include "components.hpp"
 #include "tiny_ecs.hpp"
 #include <render_system.hpp>
+#include "rng.hpp"
+#include "world_init.hpp"
+
+// stlib
+#include <vector>
+
+// What the player brings into a room that shapes it, a room planned ahead is only used if these haven't changed since
+struct RoomInputs {
+	int coins = 0;
+	int rooms_cleared = 0;
+	// Guns the shop no longer sells: bouncing, split, long and rapid shot
+	bool owned_guns[4] = { false, false, false, false };
+};
+
+RoomInputs roomInputs(Entity player);
+bool operator==(const RoomInputs& a, const RoomInputs& b);
+bool operator!=(const RoomInputs& a, const RoomInputs& b);
+
+struct PlannedItem {
+	vec2 position;
+	ITEM_ID item_id;
+	GUN_ID gun_id;
+};
+
+// Every random decision about an enemy, shop or boss room, planning one doesn't touch the registry
+// so the rooms behind the doors can be planned on a worker thread, see RoomPlanner
+struct RoomDescriptor {
+	int type = 0;
+	// The door the player comes through
+	int from = 0;
+	RoomInputs inputs;
+	bool wall_has_door[4] = { false, false, false, false };
+	// Type of the door on each wall, -1 for none
+	int door_types[4] = { -1, -1, -1, -1 };
+	std::vector<PlannedEnemy> enemies;
+	bool has_moving_wall = false;
+	vec2 wall_start = { 0.f, 0.f };
+	vec2 wall_end = { 0.f, 0.f };
+	float wall_period_ms = 0.f;
+	std::vector<PlannedItem> items;
+	bool has_boss = false;
+	int boss_coins = 0;
+};
+
+// Plans a room of type 0 (enemies), 1 (shop) or 5 (boss), the layout draws from random and the enemies from spawns
+void planRoom(RoomDescriptor& room, int type, int from, const RoomInputs& inputs, RandomStream& random, RandomStream& spawns);
+// Creates the entities of a planned room, the enemies, items and the boss go through the spawn queue
+void buildRoom(RenderSystem* renderer, Entity player, const RoomDescriptor& room);
 
 
 void createBoundaryWalls(RenderSystem* renderer);
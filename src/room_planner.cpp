@@ -0,0 +1,151 @@
+// internal
+#include "room_planner.hpp"
+#include "alloc_tracker.hpp"
+#include "profiler.hpp"
+#include "tiny_ecs_registry.hpp"
+
+// stlib
+#include <algorithm>
+
+RoomPlanner::~RoomPlanner()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	work_ready.notify_all();
+	if (worker.joinable())
+		worker.join();
+}
+
+void RoomPlanner::plan(uint64_t seed, int direction, int type, const RoomInputs& inputs, RoomDescriptor& room)
+{
+	RandomStream random;
+	RandomStream spawns;
+	random.seed(seed, (uint64_t)RNG_STREAM::ROOMS);
+	spawns.seed(seed, (uint64_t)RNG_STREAM::SPAWNS);
+	planRoom(room, type, direction, inputs, random, spawns);
+}
+
+void RoomPlanner::plan_doors(RandomStream& random, const RoomInputs& inputs)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	for (int i = 0; i < 4; i++) {
+		doors[i].seeded = false;
+		doors[i].ready = false;
+		doors[i].generation++;
+	}
+	pending.clear();
+	planned_inputs = inputs;
+
+	for (const Door& door : registry.doors.components) {
+		// Tutorial rooms are fixed
+		if (door.type != 0 && door.type != 1 && door.type != 5)
+			continue;
+		DoorPlan& plan = doors[door.direction];
+		// Drawn in sequence so the order doesn't depend on the compiler
+		uint64_t high = random.next();
+		uint64_t low = random.next();
+		plan.seeded = true;
+		plan.type = door.type;
+		plan.seed = (high << 32) | low;
+		plan.inputs = inputs;
+		request(door.direction);
+	}
+}
+
+void RoomPlanner::update(const RoomInputs& inputs)
+{
+	if (inputs == planned_inputs)
+		return;
+	planned_inputs = inputs;
+
+	std::lock_guard<std::mutex> lock(mutex);
+	for (int i = 0; i < 4; i++) {
+		if (!doors[i].seeded)
+			continue;
+		doors[i].inputs = inputs;
+		doors[i].ready = false;
+		doors[i].generation++;
+		request(i);
+	}
+}
+
+bool RoomPlanner::take(int direction, int type, const RoomInputs& inputs, RoomDescriptor& room)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	DoorPlan& door = doors[direction];
+	if (!door.seeded || door.type != type)
+		return false;
+
+	if (door.ready && door.inputs == inputs) {
+		room = std::move(door.room);
+		door.ready = false;
+		return true;
+	}
+
+	uint64_t seed = door.seed;
+	lock.unlock();
+
+	PROFILE_SCOPE("RoomPlanner::take late plan");
+	plan(seed, direction, type, inputs, room);
+	return true;
+}
+
+void RoomPlanner::clear()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	for (int i = 0; i < 4; i++) {
+		doors[i].seeded = false;
+		doors[i].ready = false;
+		doors[i].generation++;
+	}
+	pending.clear();
+}
+
+void RoomPlanner::request(int direction)
+{
+	if (std::find(pending.begin(), pending.end(), direction) == pending.end())
+		pending.push_back(direction);
+	// Started on the first request, games that never leave the tutorial don't need it
+	if (!worker.joinable())
+		worker = std::thread(&RoomPlanner::worker_loop, this);
+	work_ready.notify_one();
+}
+
+void RoomPlanner::worker_loop()
+{
+	// Planning runs across frames and would otherwise show up in the allocations of whichever frame it overlaps
+	exclude_thread_from_alloc_stats();
+	RoomDescriptor room;
+	while (true) {
+		int direction;
+		int type;
+		uint64_t seed;
+		RoomInputs inputs;
+		unsigned int generation;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			work_ready.wait(lock, [this] { return stopping || !pending.empty(); });
+			if (stopping) return;
+			direction = pending.front();
+			pending.erase(pending.begin());
+			const DoorPlan& door = doors[direction];
+			if (!door.seeded)
+				continue;
+			type = door.type;
+			seed = door.seed;
+			inputs = door.inputs;
+			generation = door.generation;
+		}
+
+		plan(seed, direction, type, inputs, room);
+
+		std::lock_guard<std::mutex> lock(mutex);
+		DoorPlan& door = doors[direction];
+		if (door.seeded && door.generation == generation) {
+			std::swap(door.room, room);
+			door.ready = true;
+		}
+	}
+}
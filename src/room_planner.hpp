@@ -0,0 +1,62 @@
+#pragma once
+
+// internal
+#include "room_generation.hpp"
+#include "rng.hpp"
+
+// stlib
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Plans the rooms behind the doors of the current room on a worker thread, so entering a room only builds a ready plan
+// Every door gets a seed from the room stream when the doors are placed and is planned from streams of its own,
+// the room behind it comes out the same whether the worker got to it first or it is planned when the player walks in
+// A plan only stays valid for the inputs it was made for, when those change the worker plans the doors again
+class RoomPlanner
+{
+public:
+	~RoomPlanner();
+
+	// Seeds the doors of the current room from random and starts planning the enemy, shop and boss rooms behind them
+	void plan_doors(RandomStream& random, const RoomInputs& inputs);
+	// Plans the doors again when the inputs differ from the ones they were planned for, once per frame
+	void update(const RoomInputs& inputs);
+	// The room behind the door, planned here if the worker isn't done with it or planned it for other inputs
+	// Returns false for doors that weren't seeded, those rooms are generated from the global streams
+	bool take(int direction, int type, const RoomInputs& inputs, RoomDescriptor& room);
+	// Forgets the doors, e.g. when the game restarts
+	void clear();
+
+private:
+	struct DoorPlan {
+		bool seeded = false;
+		int type = 0;
+		uint64_t seed = 0;
+		RoomInputs inputs;
+		// Bumped by every new request, the worker drops plans of older ones
+		unsigned int generation = 0;
+		bool ready = false;
+		RoomDescriptor room;
+	};
+
+	static void plan(uint64_t seed, int direction, int type, const RoomInputs& inputs, RoomDescriptor& room);
+	// Queues the door for the worker, mutex has to be held
+	void request(int direction);
+	void worker_loop();
+
+	// Inputs the doors were last planned for, only used by the main thread
+	RoomInputs planned_inputs;
+
+	// Guarded by mutex
+	std::array<DoorPlan, 4> doors;
+	std::vector<int> pending;
+	bool stopping = false;
+
+	std::thread worker;
+	std::mutex mutex;
+	std::condition_variable work_ready;
+};
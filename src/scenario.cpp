@@ -0,0 +1,201 @@
+// internal
+#include "scenario.hpp"
+#include "room_generation.hpp"
+#include "tiny_ecs_registry.hpp"
+#include "rng.hpp"
+#include "world_init.hpp"
+
+// stlib
+#include <fstream>
+#include <sstream>
+
+template <typename ID>
+struct NamedID {
+	const char* name;
+	ID id;
+};
+
+const NamedID<ENEMY_ID> enemy_names[] = {
+	{ "NORMAL", ENEMY_ID::NORMAL },
+	{ "ELITE", ENEMY_ID::ELITE },
+	{ "DUMMY", ENEMY_ID::DUMMY },
+	{ "ZAPPER", ENEMY_ID::ZAPPER },
+	{ "FLAMETHROWER", ENEMY_ID::FLAMETHROWER },
+	{ "BOMBER", ENEMY_ID::BOMBER },
+};
+
+const NamedID<GUN_ID> gun_names[] = {
+	{ "STRAIGHT_SHOT", GUN_ID::STRAIGHT_SHOT },
+	{ "SPLIT_SHOT", GUN_ID::SPLIT_SHOT },
+	{ "BOUNCING_SHOT", GUN_ID::BOUNCING_SHOT },
+	{ "SPLINE_SHOT", GUN_ID::SPLINE_SHOT },
+	{ "SPLIT_SPLINE_SHOT", GUN_ID::SPLIT_SPLINE_SHOT },
+	{ "RAPID_SHOT", GUN_ID::RAPID_SHOT },
+	{ "LONG_SHOT", GUN_ID::LONG_SHOT },
+	{ "OMNI_SHOT", GUN_ID::OMNI_SHOT },
+	{ "ZAP_SHOT", GUN_ID::ZAP_SHOT },
+	{ "FIRE_SHOT", GUN_ID::FIRE_SHOT },
+	{ "EXPLOSION_SHOT", GUN_ID::EXPLOSION_SHOT },
+};
+
+// Only the textures stepParticleSystems animates
+const NamedID<TEXTURE_ASSET_ID> particle_names[] = {
+	{ "SPARK_BASE", TEXTURE_ASSET_ID::SPARK_BASE },
+	{ "BULLET_DEAD_BASE", TEXTURE_ASSET_ID::BULLET_DEAD_BASE },
+	{ "ENEMY_BULLET_DEAD", TEXTURE_ASSET_ID::ENEMY_BULLET_DEAD },
+	{ "SPLINE_BULLET_DEAD", TEXTURE_ASSET_ID::SPLINE_BULLET_DEAD },
+	{ "BULLET_DEAD_ZAPPER", TEXTURE_ASSET_ID::BULLET_DEAD_ZAPPER },
+	{ "DEATH", TEXTURE_ASSET_ID::DEATH },
+	{ "DEATH_GREEN", TEXTURE_ASSET_ID::DEATH_GREEN },
+	{ "DEATH_BLUE", TEXTURE_ASSET_ID::DEATH_BLUE },
+	{ "HEART_PARTICLE", TEXTURE_ASSET_ID::HEART_PARTICLE },
+	{ "COIN", TEXTURE_ASSET_ID::COIN },
+};
+
+template <typename ID, size_t N>
+static bool parse_name(std::istringstream& line, const NamedID<ID>(&names)[N], ID& id)
+{
+	std::string name;
+	if (!(line >> name))
+		return false;
+	for (const NamedID<ID>& named : names) {
+		if (name == named.name) {
+			id = named.id;
+			return true;
+		}
+	}
+	return false;
+}
+
+// Flocking enemies are steered by the AI system, the others move on their own
+static bool is_flocking(ENEMY_ID id)
+{
+	return id == ENEMY_ID::NORMAL || id == ENEMY_ID::ELITE || id == ENEMY_ID::ZAPPER || id == ENEMY_ID::FLAMETHROWER;
+}
+
+static void createEnemies(RenderSystem* renderer, Entity player, ENEMY_ID id, int count, vec2 spawnMin, vec2 spawnMax)
+{
+	RandomStream& random = randomService.stream(RNG_STREAM::SPAWNS);
+
+	Entity flock = player;
+	if (is_flocking(id)) {
+		flock = Entity();
+		registry.flocks.emplace(flock).target = player;
+	}
+	for (int i = 0; i < count; i++) {
+		vec2 position, velocity;
+		randomSpawn(random, spawnMin, spawnMax, position, velocity);
+		Entity entity = createEnemy(renderer, position, velocity, id, false);
+		if (is_flocking(id))
+			addToFlock(flock, entity);
+		// Spread the first shots like the room generation does
+		if (registry.guns.has(entity)) {
+			Gun& gun = registry.guns.get(entity);
+			gun.timer_ms = random.uniform(0.f, gun.cooldown_ms);
+		}
+	}
+}
+
+// An invisible turret, its bullets are enemy bullets
+static void createEmitter(vec2 position, float angle, GUN_ID gun_id)
+{
+	Entity entity = Entity();
+	Motion& motion = registry.motions.emplace(entity);
+	motion.position = position;
+	motion.angle = angle;
+	motion.scale = { 50.f, 50.f };
+	equipGun(entity, gun_id).is_firing = true;
+}
+
+bool loadScenario(const std::string& path, RenderSystem* renderer, Entity player)
+{
+	std::ifstream file(path);
+	if (!file) {
+		printf("Error opening scenario: %s\n", path.c_str());
+		return false;
+	}
+
+	std::string text;
+	for (int line_number = 1; std::getline(file, text); line_number++) {
+		text = text.substr(0, text.find('#'));
+		std::istringstream line(text);
+		std::string directive;
+		if (!(line >> directive))
+			continue;
+
+		bool ok = true;
+		if (directive == "seed") {
+			unsigned long long seed;
+			ok = (bool)(line >> seed);
+			if (ok)
+				randomService.seed(seed);
+		}
+		else if (directive == "player") {
+			vec2 position;
+			ok = (bool)(line >> position.x >> position.y);
+			registry.motions.get(player).position = position;
+			// Optional health, a large value keeps the player alive so the load stays the same
+			float health;
+			if (line >> health) {
+				registry.players.get(player).health = health;
+				registry.players.get(player).max_health = health;
+			}
+		}
+		else if (directive == "boundary") {
+			createFloor(renderer, { window_width_px / 2, window_height_px / 2 }, window_width_px, window_height_px);
+			createBoundaryWalls(renderer);
+		}
+		else if (directive == "wall") {
+			vec2 position, size;
+			ok = (bool)(line >> position.x >> position.y >> size.x >> size.y);
+			if (ok)
+				createWall(renderer, position, size.x, size.y, size.x >= size.y ? WALL_ID::HORIZONTAL_LONG : WALL_ID::VERTICAL_LONG);
+		}
+		else if (directive == "moving_wall") {
+			vec2 start, end, size;
+			float period_ms;
+			ok = (bool)(line >> start.x >> start.y >> end.x >> end.y >> period_ms >> size.x >> size.y);
+			if (ok)
+				createMovingWall(renderer, start, end, period_ms, size.x, size.y);
+		}
+		else if (directive == "enemies") {
+			ENEMY_ID id;
+			int count;
+			vec2 spawnMin, spawnMax;
+			ok = parse_name(line, enemy_names, id) && (line >> count >> spawnMin.x >> spawnMin.y >> spawnMax.x >> spawnMax.y);
+			if (ok)
+				createEnemies(renderer, player, id, count, spawnMin, spawnMax);
+		}
+		else if (directive == "gun") {
+			GUN_ID id;
+			vec2 position;
+			float angle;
+			ok = parse_name(line, gun_names, id) && (line >> position.x >> position.y >> angle);
+			if (ok)
+				createEmitter(position, angle * M_PI / 180.f, id);
+		}
+		else if (directive == "particles") {
+			TEXTURE_ASSET_ID texture;
+			int count, particles;
+			vec2 position;
+			float lifetime_ms;
+			ok = parse_name(line, particle_names, texture) && (line >> count >> particles >> position.x >> position.y >> lifetime_ms);
+			RandomStream& random = randomService.stream(RNG_STREAM::PARTICLES);
+			for (int i = 0; ok && i < count; i++) {
+				vec2 velocity;
+				velocity.x = random.uniform(-300.f, 300.f);
+				velocity.y = random.uniform(-300.f, 300.f);
+				createParticleSystem(position, velocity, particles, lifetime_ms, 0.f, 10, texture);
+			}
+		}
+		else {
+			ok = false;
+		}
+
+		if (!ok) {
+			printf("Error in scenario %s line %d: %s\n", path.c_str(), line_number, text.c_str());
+			return false;
+		}
+	}
+	return true;
+}
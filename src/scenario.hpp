@@ -0,0 +1,22 @@
+#pragma once
+
+#include "common.hpp"
+#include "tiny_ecs.hpp"
+#include "render_system.hpp"
+
+// stlib
+#include <string>
+
+// Loads a stress test scenario from a text file and creates its entities through the world_init factories
+// One directive per line, everything after a # is a comment. Positions are in pixels, angles in degrees
+//   seed <n>                                              reseeds every random stream, otherwise the run's seed is kept
+//   player <x> <y> [health]                               moves the player and optionally sets its health
+//   boundary                                              floor and the four boundary walls
+//   wall <x> <y> <width> <height>
+//   moving_wall <x0> <y0> <x1> <y1> <period_ms> <width> <height>
+//   enemies <ENEMY_ID> <count> <x0> <y0> <x1> <y1>        spread over the rectangle, flocking types form a flock chasing the player
+//   gun <GUN_ID> <x> <y> <angle>                          stationary emitter that keeps firing the gun's pattern
+//   particles <TEXTURE_ASSET_ID> <count> <particles> <x> <y> <lifetime_ms>
+// Names are the enumerator names, e.g. ELITE, SPLIT_SHOT or SPARK_BASE
+// Returns false after printing the offending line if the file can't be read or parsed
+bool loadScenario(const std::string& path, RenderSystem* renderer, Entity player);
@@ -0,0 +1,217 @@
+#pragma once
+
+// stlib
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// A vector that keeps up to N elements inside itself and only allocates on the heap beyond that
+// Component lists that usually hold a handful of elements then cost no allocation and sit next to the rest of the component
+// Elements are only constructed when added, a SmallVector<Entity, N> doesn't use up N entity ids
+// Unlike std::vector, moving a SmallVector with inline elements moves the elements themselves
+template <typename T, size_t N>
+class SmallVector
+{
+public:
+	typedef T value_type;
+	typedef T* iterator;
+	typedef const T* const_iterator;
+
+	SmallVector() {}
+
+	explicit SmallVector(size_t count)
+	{
+		resize(count);
+	}
+
+	SmallVector(std::initializer_list<T> values)
+	{
+		reserve(values.size());
+		for (const T& value : values)
+			push_back(value);
+	}
+
+	SmallVector(const SmallVector& other)
+	{
+		reserve(other.count);
+		for (const T& value : other)
+			push_back(value);
+	}
+
+	SmallVector(SmallVector&& other)
+	{
+		take(other);
+	}
+
+	~SmallVector()
+	{
+		clear();
+		release();
+	}
+
+	SmallVector& operator=(const SmallVector& other)
+	{
+		if (this != &other) {
+			clear();
+			reserve(other.count);
+			for (const T& value : other)
+				push_back(value);
+		}
+		return *this;
+	}
+
+	SmallVector& operator=(SmallVector&& other)
+	{
+		if (this != &other) {
+			clear();
+			release();
+			take(other);
+		}
+		return *this;
+	}
+
+	size_t size() const { return count; }
+	size_t capacity() const { return allocated; }
+	bool empty() const { return count == 0; }
+	// True while the elements are stored inside the vector
+	bool is_inline() const { return elements == inline_elements(); }
+
+	T* data() { return elements; }
+	const T* data() const { return elements; }
+	iterator begin() { return elements; }
+	iterator end() { return elements + count; }
+	const_iterator begin() const { return elements; }
+	const_iterator end() const { return elements + count; }
+
+	T& operator[](size_t i)
+	{
+		assert(i < count && "SmallVector index out of range");
+		return elements[i];
+	}
+	const T& operator[](size_t i) const
+	{
+		assert(i < count && "SmallVector index out of range");
+		return elements[i];
+	}
+	T& front() { return (*this)[0]; }
+	T& back() { return (*this)[count - 1]; }
+
+	void push_back(const T& value)
+	{
+		// The value may be one of the elements, copy it before they move
+		if (count == allocated) {
+			T copy(value);
+			grow(count + 1);
+			new (elements + count) T(std::move(copy));
+		}
+		else {
+			new (elements + count) T(value);
+		}
+		count++;
+	}
+
+	void push_back(T&& value)
+	{
+		if (count == allocated) {
+			T moved(std::move(value));
+			grow(count + 1);
+			new (elements + count) T(std::move(moved));
+		}
+		else {
+			new (elements + count) T(std::move(value));
+		}
+		count++;
+	}
+
+	template <typename... Args>
+	T& emplace_back(Args&&... args)
+	{
+		if (count == allocated)
+			grow(count + 1);
+		new (elements + count) T(std::forward<Args>(args)...);
+		return elements[count++];
+	}
+
+	void pop_back()
+	{
+		assert(count > 0 && "SmallVector is empty");
+		elements[--count].~T();
+	}
+
+	// Destroys the elements, heap storage is kept like std::vector::clear
+	void clear()
+	{
+		for (size_t i = 0; i < count; i++)
+			elements[i].~T();
+		count = 0;
+	}
+
+	void resize(size_t new_count)
+	{
+		reserve(new_count);
+		while (count > new_count)
+			pop_back();
+		while (count < new_count)
+			emplace_back();
+	}
+
+	void reserve(size_t new_capacity)
+	{
+		if (new_capacity > allocated)
+			grow(new_capacity);
+	}
+
+private:
+	T* inline_elements() { return reinterpret_cast<T*>(&storage); }
+	const T* inline_elements() const { return reinterpret_cast<const T*>(&storage); }
+
+	// Moves the elements to heap storage for at least min_capacity of them, growing geometrically
+	void grow(size_t min_capacity)
+	{
+		size_t new_capacity = std::max(min_capacity, 2 * allocated);
+		T* moved = static_cast<T*>(::operator new(new_capacity * sizeof(T)));
+		for (size_t i = 0; i < count; i++) {
+			new (moved + i) T(std::move(elements[i]));
+			elements[i].~T();
+		}
+		release();
+		elements = moved;
+		allocated = new_capacity;
+	}
+
+	// Frees heap storage and goes back to the inline elements, they have to be destroyed already
+	void release()
+	{
+		if (!is_inline())
+			::operator delete(elements);
+		elements = inline_elements();
+		allocated = N;
+	}
+
+	// Takes over the elements of other, which is left empty, this vector has to be empty and inline
+	void take(SmallVector& other)
+	{
+		if (other.is_inline()) {
+			for (size_t i = 0; i < other.count; i++)
+				new (elements + i) T(std::move(other.elements[i]));
+			count = other.count;
+			other.clear();
+			return;
+		}
+		elements = other.elements;
+		allocated = other.allocated;
+		count = other.count;
+		other.elements = other.inline_elements();
+		other.allocated = N;
+		other.count = 0;
+	}
+
+	typename std::aligned_storage<sizeof(T) * N, alignof(T)>::type storage;
+	T* elements = inline_elements();
+	size_t count = 0;
+	size_t allocated = N;
+};
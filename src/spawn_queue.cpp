@@ -0,0 +1,38 @@
+// internal
+#include "spawn_queue.hpp"
+#include "profiler.hpp"
+
+SpawnQueue spawnQueue;
+
+void SpawnQueue::run_next()
+{
+	// A spawn may push more spawns, which can move the one that is running
+	std::function<void()> spawn = std::move(waiting[next++]);
+	spawn();
+	if (next == waiting.size()) {
+		waiting.clear();
+		next = 0;
+	}
+}
+
+void SpawnQueue::step()
+{
+	PROFILE_SCOPE("SpawnQueue::step");
+	for (int i = 0; i < spawns_per_frame && size() > 0; i++)
+		run_next();
+}
+
+void SpawnQueue::finish()
+{
+	PROFILE_SCOPE("SpawnQueue::finish");
+	while (size() > 0)
+		run_next();
+	staging = false;
+}
+
+void SpawnQueue::clear()
+{
+	waiting.clear();
+	next = 0;
+	staging = false;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+// stlib
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <vector>
+
+// Spreads the spawns of a room over the frames of the room transition instead of creating the whole room in one frame
+// Room generation pushes what it spawns through the queue. Outside of staging a spawn runs right away,
+// while staging it waits and step() runs at most spawns_per_frame of them per frame, in the order they were pushed
+// The budget counts spawns rather than time so that a staged room comes out the same on every machine
+class SpawnQueue
+{
+public:
+	// Spawns run per frame while staging, a spawn creates one enemy, item or obstacle
+	int spawns_per_frame = 3;
+
+	// Spawns pushed from now on wait for step()
+	void begin_staging() { staging = true; }
+	// Runs the spawns that are still waiting and goes back to spawning right away
+	void finish();
+	// Drops the waiting spawns, for when the world they were meant for is gone
+	void clear();
+
+	template <typename Spawn>
+	void push(Spawn spawn)
+	{
+		if (!staging) {
+			spawn();
+			return;
+		}
+		waiting.push_back(std::function<void()>(std::move(spawn)));
+	}
+
+	// Runs the next spawns within the budget of the frame
+	void step();
+
+	bool is_staging() const { return staging; }
+	size_t size() const { return waiting.size() - next; }
+
+private:
+	void run_next();
+
+	std::vector<std::function<void()>> waiting;
+	size_t next = 0;
+	bool staging = false;
+};
+
+extern SpawnQueue spawnQueue;
@@ -0,0 +1,118 @@
+// internal
+#include "spline_arena.hpp"
+#include "tiny_ecs_registry.hpp"
+
+// stlib
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+SplineArena splineArena;
+const int SplineArena::samples_per_curve;
+
+// The curve is measured along this many points before it is resampled at equal distances
+const int FINE_SAMPLES = 64;
+
+void release_spline_curve(Entity, SplineBullet& spline)
+{
+	splineArena.remove(spline.curve);
+}
+
+vec2 catmullrom(vec2 p0, vec2 p1, vec2 p2, vec2 p3, float t) {
+	float t2 = t * t;
+	float t3 = t2 * t;
+
+	vec2 v0 = (p2 - p0) * 0.5f;
+	vec2 v1 = (p3 - p1) * 0.5f;
+
+	float a1 = 2 * t3 - 3 * t2 + 1;
+	float a2 = t3 - 2 * t2 + t;
+	float a3 = -2 * t3 + 3 * t2;
+	float a4 = t3 - t2;
+
+	return a1 * p1 + a2 * v0 + a3 * p2 + a4 * v1;
+}
+
+void SplineArena::reserve(size_t count)
+{
+	points.reserve(count * samples_per_curve);
+	directions.reserve(count * samples_per_curve);
+	angles.reserve(count * samples_per_curve);
+	lengths.reserve(count);
+	free_curves.reserve(count);
+}
+
+int SplineArena::add(vec2 start, vec2 middle, vec2 end)
+{
+	assert(start != end && "Spline without length");
+
+	int curve;
+	if (!free_curves.empty()) {
+		curve = free_curves.back();
+		free_curves.pop_back();
+	}
+	else {
+		curve = (int)lengths.size();
+		lengths.push_back(0.f);
+		points.resize(points.size() + samples_per_curve);
+		directions.resize(directions.size() + samples_per_curve);
+		angles.resize(angles.size() + samples_per_curve);
+		// Every curve can be freed at once without growing the list
+		free_curves.reserve(lengths.capacity());
+	}
+
+	// Measure the curve along closely spaced points, the first half of them on the segment to the middle point
+	vec2 fine[FINE_SAMPLES];
+	float distance_to[FINE_SAMPLES];
+	for (int i = 0; i < FINE_SAMPLES; i++) {
+		float t = 2.f * i / (FINE_SAMPLES - 1);
+		if (t < 1.f)
+			fine[i] = catmullrom(start, start, middle, end, t);
+		else
+			fine[i] = catmullrom(start, middle, end, end, t - 1.f);
+		distance_to[i] = i == 0 ? 0.f : distance_to[i - 1] + glm::distance(fine[i - 1], fine[i]);
+	}
+	float length = distance_to[FINE_SAMPLES - 1];
+	lengths[curve] = length;
+
+	// Place the samples at equal distances by walking along the measured points
+	int first = curve * samples_per_curve;
+	int j = 0;
+	for (int i = 0; i < samples_per_curve; i++) {
+		float target = length * i / (samples_per_curve - 1);
+		while (j < FINE_SAMPLES - 2 && distance_to[j + 1] < target)
+			j++;
+		float segment_length = distance_to[j + 1] - distance_to[j];
+		float fraction = segment_length > 0.f ? std::min((target - distance_to[j]) / segment_length, 1.f) : 0.f;
+		points[first + i] = fine[j] + (fine[j + 1] - fine[j]) * fraction;
+	}
+
+	for (int i = 0; i < samples_per_curve - 1; i++) {
+		vec2 segment = points[first + i + 1] - points[first + i];
+		directions[first + i] = glm::normalize(segment);
+		angles[first + i] = atan2(segment.y, segment.x);
+	}
+	directions[first + samples_per_curve - 1] = directions[first + samples_per_curve - 2];
+	angles[first + samples_per_curve - 1] = angles[first + samples_per_curve - 2];
+	return curve;
+}
+
+void SplineArena::remove(int curve)
+{
+	assert(curve >= 0 && curve < (int)lengths.size() && "Not a curve of the arena");
+	free_curves.push_back(curve);
+}
+
+SplinePoint SplineArena::evaluate(int curve, float distance) const
+{
+	float spacing = lengths[curve] / (samples_per_curve - 1);
+	float along = std::min(std::max(distance / spacing, 0.f), (float)(samples_per_curve - 1));
+	int segment = std::min((int)along, samples_per_curve - 2);
+	int sample = curve * samples_per_curve + segment;
+
+	SplinePoint point;
+	point.position = points[sample] + (points[sample + 1] - points[sample]) * (along - segment);
+	point.direction = directions[sample];
+	point.angle = angles[sample];
+	return point;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+// internal
+#include "common.hpp"
+
+// stlib
+#include <vector>
+
+vec2 catmullrom(vec2 p0, vec2 p1, vec2 p2, vec2 p3, float t);
+
+// A point on a curve, with the direction the curve goes on in
+struct SplinePoint {
+	vec2 position;
+	vec2 direction;
+	float angle;
+};
+
+// The curves of all spline bullets, stored back to back in one array
+// Every curve is resampled at equal distances along it, so a point is found from the distance
+// travelled with one division and its direction is looked up instead of computed every frame
+// Curves of destroyed bullets are reused, adding one doesn't allocate once the arena has grown
+class SplineArena
+{
+public:
+	static const int samples_per_curve = 20;
+
+	// Makes room for count curves
+	void reserve(size_t count);
+
+	// Samples the Catmull-Rom spline from start through the middle point to end and returns the curve's index
+	// start and end have to be apart, a curve without length has no direction
+	int add(vec2 start, vec2 middle, vec2 end);
+	void remove(int curve);
+
+	float length(int curve) const { return lengths[curve]; }
+
+	// The point at the distance along the curve, clamped to its ends
+	SplinePoint evaluate(int curve, float distance) const;
+
+	// Number of curves in use
+	size_t size() const { return lengths.size() - free_curves.size(); }
+
+private:
+	// samples_per_curve entries per curve, the direction and angle are those of the segment after the sample
+	// The last sample of a curve repeats the direction of the segment before it
+	std::vector<vec2> points;
+	std::vector<vec2> directions;
+	std::vector<float> angles;
+	std::vector<float> lengths;
+	std::vector<int> free_curves;
+};
+
+extern SplineArena splineArena;
@@ -0,0 +1,169 @@
+// internal
+#include "state_hash.hpp"
+#include "bullet_system.hpp"
+#include "rng.hpp"
+#include "tiny_ecs_registry.hpp"
+
+// stlib
+#include <algorithm>
+#include <cinttypes>
+
+// 64 bit FNV-1a
+const uint64_t fnv_offset_basis = 14695981039346656037ULL;
+const uint64_t fnv_prime = 1099511628211ULL;
+
+static void hash_bytes(uint64_t& hash, const void* data, size_t size)
+{
+	const unsigned char* bytes = (const unsigned char*)data;
+	for (size_t i = 0; i < size; i++) {
+		hash ^= bytes[i];
+		hash *= fnv_prime;
+	}
+}
+
+// Fields are hashed one by one so padding bytes never end up in the hash
+template <typename T>
+static void hash_value(uint64_t& hash, const T& value)
+{
+	hash_bytes(hash, &value, sizeof(T));
+}
+
+static void hash_value(uint64_t& hash, const vec2& value)
+{
+	hash_value(hash, value.x);
+	hash_value(hash, value.y);
+}
+
+static void hash_component(uint64_t& hash, const Motion& motion)
+{
+	hash_value(hash, motion.position);
+	hash_value(hash, motion.angle);
+	hash_value(hash, motion.velocity);
+	hash_value(hash, motion.scale);
+}
+
+static void hash_component(uint64_t& hash, const Enemy& enemy)
+{
+	hash_value(hash, enemy.health);
+	hash_value(hash, enemy.max_health);
+	hash_value(hash, enemy.coin_drop);
+	hash_value(hash, enemy.id);
+}
+
+static void hash_component(uint64_t& hash, const Player& player)
+{
+	hash_value(hash, player.mouse_position);
+	hash_value(hash, player.health);
+	hash_value(hash, player.max_health);
+	hash_value(hash, player.range);
+	hash_value(hash, player.max_range);
+	hash_value(hash, player.coins);
+	hash_value(hash, player.immune);
+	hash_value(hash, player.right);
+	hash_value(hash, player.left);
+	hash_value(hash, player.up);
+	hash_value(hash, player.down);
+	hash_value(hash, player.roomsCleared);
+	hash_value(hash, player.last_door);
+}
+
+static void hash_component(uint64_t& hash, const Projectile& projectile)
+{
+	hash_value(hash, projectile.shot_by_player);
+	hash_value(hash, projectile.can_richochet);
+	hash_value(hash, projectile.piercing);
+	hash_value(hash, projectile.explodes);
+	hash_value(hash, projectile.max_distance);
+	hash_value(hash, projectile.distance_travelled);
+	hash_value(hash, projectile.damage);
+	for (Entity hit : projectile.hit_entities)
+		hash_value(hash, (unsigned int)hit);
+}
+
+static void hash_component(uint64_t& hash, const Boss& boss)
+{
+	hash_value(hash, boss.health);
+	hash_value(hash, boss.max_health);
+	hash_value(hash, boss.coin_drop);
+	hash_value(hash, boss.max_drop);
+	hash_value(hash, boss.cooldown);
+	hash_value(hash, boss.id);
+}
+
+// Storage order depends on the order of removals, so the components are visited by entity instead
+template <typename Component>
+static uint64_t hash_container(ComponentContainer<Component>& container, std::vector<std::pair<unsigned int, unsigned int>>& order)
+{
+	order.clear();
+	for (unsigned int i = 0; i < container.entities.size(); i++)
+		order.push_back({ (unsigned int)container.entities[i], i });
+	std::sort(order.begin(), order.end());
+
+	uint64_t hash = fnv_offset_basis;
+	for (const std::pair<unsigned int, unsigned int>& entry : order) {
+		hash_value(hash, entry.first);
+		hash_component(hash, container.components[entry.second]);
+	}
+	return hash;
+}
+
+// The bullets of the bullet system are part of the projectile hash, they are kept in spawn order
+static void hash_bullets(uint64_t& hash, const BulletSystem& bullets)
+{
+	for (size_t i = 0; i < bullets.size(); i++) {
+		hash_value(hash, bullets.position_x[i]);
+		hash_value(hash, bullets.position_y[i]);
+		hash_value(hash, bullets.velocity_x[i]);
+		hash_value(hash, bullets.velocity_y[i]);
+		hash_value(hash, bullets.range_left[i]);
+		hash_value(hash, bullets.damage[i]);
+		hash_value(hash, bullets.style[i]);
+	}
+}
+
+StateHashRecorder::~StateHashRecorder()
+{
+	close();
+}
+
+bool StateHashRecorder::open(const std::string& path)
+{
+	close();
+	file = fopen(path.c_str(), "w");
+	if (file == NULL) {
+		printf("Can't write the state hashes to %s\n", path.c_str());
+		return false;
+	}
+	fprintf(file, "# seed %llu\n", (unsigned long long)randomService.get_seed());
+	fprintf(file, "# frame");
+	for (int i = 0; i < hashed_component_count; i++)
+		fprintf(file, " %s", hashed_component_names[i]);
+	fprintf(file, "\n");
+	return true;
+}
+
+void StateHashRecorder::close()
+{
+	if (file)
+		fclose(file);
+	file = nullptr;
+}
+
+StateHash StateHashRecorder::record(long long frame)
+{
+	StateHash state;
+	state.components[(int)HASHED_COMPONENT::MOTION] = hash_container(registry.motions, order);
+	state.components[(int)HASHED_COMPONENT::ENEMY] = hash_container(registry.enemies, order);
+	state.components[(int)HASHED_COMPONENT::PLAYER] = hash_container(registry.players, order);
+	state.components[(int)HASHED_COMPONENT::PROJECTILE] = hash_container(registry.projectiles, order);
+	hash_bullets(state.components[(int)HASHED_COMPONENT::PROJECTILE], bulletSystem);
+	state.components[(int)HASHED_COMPONENT::BOSS] = hash_container(registry.bosses, order);
+
+	if (file) {
+		fprintf(file, "%lld", frame);
+		for (int i = 0; i < hashed_component_count; i++)
+			fprintf(file, " %016" PRIx64, state.components[i]);
+		fprintf(file, "\n");
+	}
+	return state;
+}
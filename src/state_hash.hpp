@@ -0,0 +1,46 @@
+#pragma once
+
+// stlib
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Hashes of the gameplay state at the end of a frame, one per component type
+// Two runs that should play out the same, e.g. before and after an optimization, must produce the same stream of hashes
+// Components are hashed in entity order and field by field, floats by their bit pattern, so any change in the results shows up
+enum class HASHED_COMPONENT {
+	MOTION = 0,
+	ENEMY = MOTION + 1,
+	PLAYER = ENEMY + 1,
+	PROJECTILE = PLAYER + 1,
+	BOSS = PROJECTILE + 1,
+	HASHED_COMPONENT_COUNT = BOSS + 1
+};
+const int hashed_component_count = (int)HASHED_COMPONENT::HASHED_COMPONENT_COUNT;
+
+const char* const hashed_component_names[hashed_component_count] = { "Motion", "Enemy", "Player", "Projectile", "Boss" };
+
+struct StateHash {
+	uint64_t components[hashed_component_count];
+};
+
+// Writes one line per frame: the frame index followed by the hash of every component type in hexadecimal
+// The file starts with comment lines holding the random seed and naming the columns, compare two files with treasuregunner_hashdiff
+class StateHashRecorder
+{
+public:
+	~StateHashRecorder();
+
+	bool open(const std::string& path);
+	void close();
+
+	// Hashes the registry, and appends it to the file when one is open
+	StateHash record(long long frame);
+
+private:
+	FILE* file = nullptr;
+	// (entity, component index) pairs sorted by entity, kept to avoid allocating every frame
+	std::vector<std::pair<unsigned int, unsigned int>> order;
+};
@@ -0,0 +1,98 @@
+// internal
+#include "telemetry.hpp"
+
+// stlib
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+Telemetry telemetry;
+
+const char* room_type_names[room_type_count] = { "tutorial", "enemy", "shop", "boss" };
+
+int Histogram::bucket_of(unsigned long long us)
+{
+	if (us < sub_bucket_count)
+		return (int)us;
+	// Position of the highest set bit, at least sub_bucket_bits here
+	int magnitude = 0;
+	while ((us >> magnitude) >= 2 * sub_bucket_count)
+		magnitude++;
+	int bucket = sub_bucket_count * (magnitude + 1) + (int)(us >> magnitude) - sub_bucket_count;
+	return std::min(bucket, bucket_count - 1);
+}
+
+unsigned long long Histogram::bucket_upper_bound(int bucket)
+{
+	if (bucket < sub_bucket_count)
+		return bucket;
+	int magnitude = bucket / sub_bucket_count - 1;
+	unsigned long long sub_bucket = bucket % sub_bucket_count + sub_bucket_count;
+	return ((sub_bucket + 1) << magnitude) - 1;
+}
+
+void Histogram::record(float ms)
+{
+	unsigned long long us = (unsigned long long)std::max(0.0, std::round(ms * 1000.0));
+	counts[bucket_of(us)]++;
+	total++;
+	max_us = std::max(max_us, us);
+}
+
+float Histogram::percentile(float p) const
+{
+	if (total == 0)
+		return 0.f;
+	long long target = std::max(1LL, (long long)std::ceil(p / 100.0 * total));
+	long long seen = 0;
+	for (int bucket = 0; bucket < bucket_count; bucket++) {
+		seen += counts[bucket];
+		if (seen >= target)
+			return std::min(bucket_upper_bound(bucket), max_us) / 1000.f;
+	}
+	return max();
+}
+
+Histogram& Telemetry::histogram(const char* name)
+{
+	for (Metric& metric : metrics) {
+		if (strcmp(metric.name, name) == 0)
+			return metric.histograms[(int)room_type];
+	}
+	metrics.push_back({ name, {} });
+	return metrics.back().histograms[(int)room_type];
+}
+
+void Telemetry::record_frame(float frame_ms, const ProfileFrame* frame)
+{
+	histogram("frame").record(frame_ms);
+	if (!frame)
+		return;
+	for (const ProfileZone& zone : frame->zones) {
+		if (zone.depth == 0)
+			histogram(zone.name).record((zone.end_ns - zone.start_ns) / 1e6f);
+	}
+}
+
+bool Telemetry::write_csv(const std::string& path) const
+{
+	FILE* file = fopen(path.c_str(), "w");
+	if (file == NULL) {
+		printf("Can't write the telemetry to %s\n", path.c_str());
+		return false;
+	}
+	fprintf(file, "room_type,metric,count,p50_ms,p95_ms,p99_ms,max_ms\n");
+	for (int type = 0; type < room_type_count; type++) {
+		for (const Metric& metric : metrics) {
+			const Histogram& histogram = metric.histograms[type];
+			if (histogram.count() == 0)
+				continue;
+			fprintf(file, "%s,%s,%lld,%.3f,%.3f,%.3f,%.3f\n", room_type_names[type], metric.name, histogram.count(),
+				histogram.percentile(50.f), histogram.percentile(95.f), histogram.percentile(99.f), histogram.max());
+		}
+	}
+	fclose(file);
+	printf("Frame telemetry written to %s\n", path.c_str());
+	return true;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "profiler.hpp"
+
+// stlib
+#include <array>
+#include <string>
+#include <vector>
+
+// Log-linear histogram in the style of HdrHistogram, values are recorded in whole microseconds
+// Values below sub_bucket_count are exact, above that every power of two is split into sub_bucket_count buckets (about 3% precision)
+class Histogram
+{
+public:
+	void record(float ms);
+	// Upper bound in ms of the bucket holding the given percentile (0 - 100), never more than the maximum
+	float percentile(float p) const;
+	float max() const { return max_us / 1000.f; }
+	long long count() const { return total; }
+
+private:
+	static const int sub_bucket_bits = 5;
+	static const int sub_bucket_count = 1 << sub_bucket_bits;
+	// Enough powers of two for a little over a day
+	static const int magnitude_count = 32;
+	static const int bucket_count = sub_bucket_count * (magnitude_count + 1);
+
+	static int bucket_of(unsigned long long us);
+	static unsigned long long bucket_upper_bound(int bucket);
+
+	std::array<unsigned int, bucket_count> counts = {};
+	long long total = 0;
+	unsigned long long max_us = 0;
+};
+
+// The kinds of rooms enter_room can build, frame times are reported for each separately
+enum class ROOM_TYPE {
+	TUTORIAL = 0,
+	ENEMY = TUTORIAL + 1,
+	SHOP = ENEMY + 1,
+	BOSS = SHOP + 1,
+	ROOM_TYPE_COUNT = BOSS + 1
+};
+const int room_type_count = (int)ROOM_TYPE::ROOM_TYPE_COUNT;
+
+// Frame time and per-system time distributions for every room type
+// The systems are the top level zones of the profiler, so only the frame time is kept when the profiler is compiled out
+class Telemetry
+{
+public:
+	void set_room_type(ROOM_TYPE type) { room_type = type; }
+	ROOM_TYPE get_room_type() const { return room_type; }
+
+	// Records the time of a whole frame and of each top level zone of the profiled frame
+	void record_frame(float frame_ms, const ProfileFrame* frame);
+
+	// One row per room type and metric with the count, p50, p95, p99 and max in ms
+	bool write_csv(const std::string& path) const;
+
+private:
+	struct Metric {
+		const char* name;
+		std::array<Histogram, room_type_count> histograms;
+	};
+
+	Histogram& histogram(const char* name);
+
+	std::vector<Metric> metrics;
+	ROOM_TYPE room_type = ROOM_TYPE::TUTORIAL;
+};
+
+extern Telemetry telemetry;
@@ -0,0 +1,87 @@
+// internal
+#include "thread_pool.hpp"
+
+ThreadPool::ThreadPool() : ThreadPool(std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() - 1 : 0)
+{
+}
+
+ThreadPool::ThreadPool(unsigned int worker_count)
+{
+	next_chunk = 0;
+	for (unsigned int i = 0; i < worker_count; i++) {
+		workers.emplace_back(&ThreadPool::worker_loop, this);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	work_ready.notify_all();
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+}
+
+void ThreadPool::parallel_for(int count, int min_chunk, const std::function<void(int begin, int end)>& job)
+{
+	if (count <= 0) return;
+	int max_chunks = (int)workers.size() + 1;
+	// Rounding down keeps every chunk at min_chunk elements or more
+	int chunks = std::min(max_chunks, count / std::max(min_chunk, 1));
+	if (chunks <= 1) {
+		job(0, count);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		this->job = &job;
+		this->count = count;
+		chunk_count = chunks;
+		next_chunk = 0;
+		workers_pending = (unsigned int)workers.size();
+		generation++;
+	}
+	work_ready.notify_all();
+
+	run_chunks();
+
+	// Every worker has to finish with this job before it goes out of scope
+	std::unique_lock<std::mutex> lock(mutex);
+	work_done.wait(lock, [this] { return workers_pending == 0; });
+	this->job = nullptr;
+}
+
+void ThreadPool::run_chunks()
+{
+	for (int chunk = next_chunk++; chunk < chunk_count; chunk = next_chunk++) {
+		// Spread the elements evenly so chunk sizes differ by at most one
+		int begin = (int)((long long)chunk * count / chunk_count);
+		int end = (int)((long long)(chunk + 1) * count / chunk_count);
+		(*job)(begin, end);
+	}
+}
+
+void ThreadPool::worker_loop()
+{
+	unsigned int seen_generation = 0;
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			work_ready.wait(lock, [this, seen_generation] { return stopping || generation != seen_generation; });
+			if (stopping) return;
+			seen_generation = generation;
+		}
+
+		run_chunks();
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			workers_pending--;
+		}
+		work_done.notify_one();
+	}
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+// stlib
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A fixed set of worker threads for splitting data parallel loops into chunks
+// The calling thread takes part in the work and parallel_for only returns once every chunk is done
+class ThreadPool
+{
+public:
+	// By default use one worker per hardware thread besides the calling thread
+	ThreadPool();
+	ThreadPool(unsigned int worker_count);
+	~ThreadPool();
+
+	// Calls job(begin, end) on consecutive ranges covering [0, count)
+	// Ranges contain at least min_chunk elements, loops shorter than 2 * min_chunk run entirely on the calling thread
+	void parallel_for(int count, int min_chunk, const std::function<void(int begin, int end)>& job);
+
+	unsigned int worker_count() const { return (unsigned int)workers.size(); }
+
+private:
+	void worker_loop();
+	void run_chunks();
+
+	std::vector<std::thread> workers;
+	std::mutex mutex;
+	std::condition_variable work_ready;
+	std::condition_variable work_done;
+	bool stopping = false;
+
+	// State of the current parallel_for, guarded by mutex except for next_chunk
+	const std::function<void(int, int)>* job = nullptr;
+	int count = 0;
+	int chunk_count = 0;
+	std::atomic<int> next_chunk;
+	unsigned int generation = 0;
+	unsigned int workers_pending = 0;
+};
@@ -8,25 +8,175 @@
 #include <functional>
 #include <typeindex>
 #include <assert.h>
+#include <cstdio>
+#include <cstdlib>
+
+// What an entity belongs to, leaving a room drops all its entities at once, see ECSRegistry::clear_scope
+// Room content is the default, the player and the screen state persist and UI entities outlive rooms and the run
+enum class ENTITY_SCOPE {
+	ROOM = 0,
+	PERSISTENT = ROOM + 1,
+	UI = PERSISTENT + 1,
+	ENTITY_SCOPE_COUNT = UI + 1
+};
+const int entity_scope_count = (int)ENTITY_SCOPE::ENTITY_SCOPE_COUNT;
 
 // Unique identifyer for all entities
+// The scope is kept in the top bits of the id, room entities have none so their ids are plain counts
 class Entity
 {
 	unsigned int id;
 	static unsigned int id_count; // starts from 1, entit 0 is the default initialization
+	static const unsigned int scope_shift = 30;
 public:
-	Entity()
+	Entity() : Entity(ENTITY_SCOPE::ROOM)
+	{
+	}
+	explicit Entity(ENTITY_SCOPE scope)
 	{
-		id = id_count++;
+		// Past this point ids would carry the bits of another scope and room teardown would silently miss entities
+		if (id_count >= (1u << scope_shift)) {
+			fprintf(stderr, "Entity ids ran into the scope bits\n");
+			abort();
+		}
+		id = id_count++ | ((unsigned int)scope << scope_shift);
 		// Note, indices of already deleted entities arent re-used in this simple implementation.
 	}
 	operator unsigned int() { return id; } // this enables automatic casting to int
+	ENTITY_SCOPE scope() const { return (ENTITY_SCOPE)(id >> scope_shift); }
+};
+
+// Splits a list of components into one segment per scope, stored in the order UI, persistent, room
+// Room components come last, so adding and removing them is the push and swap with the last element it would be without scopes
+// and dropping the room only truncates the list
+struct ScopeSegments
+{
+	// End of every segment, a segment starts where the one before it ends
+	std::array<unsigned int, entity_scope_count> ends = {};
+
+	static unsigned int segment_of(ENTITY_SCOPE scope) { return entity_scope_count - 1 - (unsigned int)scope; }
+	unsigned int begin_of(ENTITY_SCOPE scope) const { unsigned int segment = segment_of(scope); return segment == 0 ? 0 : ends[segment - 1]; }
+	unsigned int end_of(ENTITY_SCOPE scope) const { return ends[segment_of(scope)]; }
+
+	// Moves the component just appended to the end of its scope's segment, every later segment hands its first component to its end
+	// on_move(entity, index) is called for the components that moved, returns the index of the new component
+	template <typename Component, typename OnMove>
+	unsigned int place_last(std::vector<Component>& components, std::vector<Entity>& entities, ENTITY_SCOPE scope, OnMove on_move)
+	{
+		unsigned int index = (unsigned int)components.size() - 1;
+		for (unsigned int segment = entity_scope_count - 1; segment > segment_of(scope); segment--) {
+			unsigned int first = ends[segment - 1];
+			if (first != index) {
+				std::swap(components[first], components[index]);
+				std::swap(entities[first], entities[index]);
+				on_move(entities[index], index);
+			}
+			index = first;
+			ends[segment]++;
+		}
+		ends[segment_of(scope)]++;
+		return index;
+	}
+
+	// Removes the component at index, the last component of its segment fills the gap and every later segment passes the gap on
+	template <typename Component, typename OnMove>
+	void remove(std::vector<Component>& components, std::vector<Entity>& entities, ENTITY_SCOPE scope, unsigned int index, OnMove on_move)
+	{
+		for (unsigned int segment = segment_of(scope); segment < (unsigned int)entity_scope_count; segment++) {
+			unsigned int last = ends[segment] - 1;
+			if (index != last) {
+				// Note, components[index] = components[last] would trigger the copy instead of move operator
+				components[index] = std::move(components[last]);
+				entities[index] = entities[last];
+				on_move(entities[index], index);
+			}
+			index = last;
+			ends[segment]--;
+		}
+		components.pop_back();
+		entities.pop_back();
+	}
+
+	// Drops the segment of the scope, the later segments move down and on_move is called for each of their components
+	template <typename Component, typename OnMove>
+	void erase(std::vector<Component>& components, std::vector<Entity>& entities, ENTITY_SCOPE scope, OnMove on_move)
+	{
+		unsigned int begin = begin_of(scope);
+		unsigned int count = end_of(scope) - begin;
+		if (count == 0)
+			return;
+		components.erase(components.begin() + begin, components.begin() + begin + count);
+		entities.erase(entities.begin() + begin, entities.begin() + begin + count);
+		for (unsigned int i = begin; i < entities.size(); i++)
+			on_move(entities[i], i);
+		for (unsigned int segment = segment_of(scope); segment < (unsigned int)entity_scope_count; segment++)
+			ends[segment] -= count;
+	}
+
+	void clear() { ends.fill(0); }
+};
+
+// Allocator for the entity -> index maps, it keeps freed hash nodes on a free list instead of returning them to the heap
+// Inserting after a removal then reuses the node, so spawning and destroying entities doesn't allocate once warmed up
+// The free list is shared by all maps with the same node type and is not thread safe, like the registry itself
+template <typename T>
+struct RecyclingAllocator
+{
+	typedef T value_type;
+
+	RecyclingAllocator() {}
+	template <typename U>
+	RecyclingAllocator(const RecyclingAllocator<U>&) {}
+
+	T* allocate(size_t n)
+	{
+		FreeNode*& free_list = free_nodes();
+		if (n == 1 && sizeof(T) >= sizeof(FreeNode) && free_list) {
+			FreeNode* node = free_list;
+			free_list = node->next;
+			return reinterpret_cast<T*>(node);
+		}
+		return static_cast<T*>(::operator new(n * sizeof(T)));
+	}
+
+	void deallocate(T* ptr, size_t n)
+	{
+		// Bucket arrays are returned to the heap, only single nodes are kept
+		if (n == 1 && sizeof(T) >= sizeof(FreeNode)) {
+			FreeNode* node = reinterpret_cast<FreeNode*>(ptr);
+			node->next = free_nodes();
+			free_nodes() = node;
+			return;
+		}
+		::operator delete(ptr);
+	}
+
+private:
+	struct FreeNode {
+		FreeNode* next;
+	};
+
+	static FreeNode*& free_nodes()
+	{
+		static FreeNode* head = nullptr;
+		return head;
+	}
 };
 
+template <typename T, typename U>
+bool operator==(const RecyclingAllocator<T>&, const RecyclingAllocator<U>&) { return true; }
+template <typename T, typename U>
+bool operator!=(const RecyclingAllocator<T>&, const RecyclingAllocator<U>&) { return false; }
+
+template <typename Value>
+using EntityMap = std::unordered_map<unsigned int, Value, std::hash<unsigned int>, std::equal_to<unsigned int>, RecyclingAllocator<std::pair<const unsigned int, Value>>>;
+
 // Common interface to refer to all containers in the ECS registry
 struct ContainerInterface
 {
 	virtual void clear() = 0;
+	// Removes the components of every entity of the scope
+	virtual void clear_scope(ENTITY_SCOPE scope) = 0;
 	virtual size_t size() = 0;
 	virtual void remove(Entity e) = 0;
 	virtual bool has(Entity entity) = 0;
@@ -37,16 +187,30 @@ template <typename Component> // A component can be any class
 class ComponentContainer : public ContainerInterface
 {
 private:
-	// The hash map from Entity -> array index.
-	std::unordered_map<unsigned int, unsigned int> map_entity_componentID; // the entity is cast to uint to be hashable.
+	// The hash maps from Entity -> array index, one per scope so that a scope is forgotten with one clear
+	std::array<EntityMap<unsigned int>, entity_scope_count> map_entity_componentID; // the entity is cast to uint to be hashable.
+	ScopeSegments segments;
 	bool registered = false;
+
+	EntityMap<unsigned int>& map_of(Entity e) { return map_entity_componentID[(int)e.scope()]; }
+
+	// Keeps the maps up to date as the segments move components around
+	struct IndexUpdate {
+		ComponentContainer* container;
+		void operator()(Entity e, unsigned int index) const { container->map_of(e)[e] = index; }
+	};
 public:
 	// Container of all components of type 'Component'
+	// The components of each scope are stored together, see ScopeSegments
 	std::vector<Component> components;
 
 	// The corresponding entities
 	std::vector<Entity> entities;
 
+	// Optional callback run right before the component of an entity is removed
+	// It is run when a scope is cleared but not when the whole container is
+	std::function<void(Entity, Component&)> on_remove;
+
 	// Constructor that registers the type
 	ComponentContainer()
 	{
@@ -58,10 +222,11 @@ public:
 		// Usually, every entity should only have one instance of each component type
 		assert(!(check_for_duplicates && has(e)) && "Entity already contained in ECS registry");
 
-		map_entity_componentID[e] = (unsigned int)components.size();
 		components.push_back(std::move(c)); // the move enforces move instead of copy constructor
 		entities.push_back(e);
-		return components.back();
+		unsigned int index = segments.place_last(components, entities, e.scope(), IndexUpdate{ this });
+		map_of(e)[e] = index;
+		return components[index];
 	};
 
 	// The emplace function takes the the provided arguments Args, creates a new object of type Component, and inserts it into the ECS system
@@ -77,32 +242,29 @@ public:
 	// A wrapper to return the component of an entity
 	Component& get(Entity e) {
 		assert(has(e) && "Entity not contained in ECS registry");
-		return components[map_entity_componentID[e]];
+		return components[map_of(e)[e]];
 	}
 
 	// Check if entity has a component of type 'Component'
 	bool has(Entity entity) {
-		return map_entity_componentID.count(entity) > 0;
+		return map_of(entity).count(entity) > 0;
 	}
 
 	// Remove a component and pack the container to re-use the empty space
 	void remove(Entity e)
 	{
-		if (has(e))
+		EntityMap<unsigned int>& map = map_of(e);
+		auto it = map.find(e);
+		if (it != map.end())
 		{
 			// Get the current position
-			int cID = map_entity_componentID[e];
+			unsigned int cID = it->second;
 
-			// Move the last element to position cID using the move operator
-			// Note, components[cID] = components.back() would trigger the copy instead of move operator
-			components[cID] = std::move(components.back());
-			entities[cID] = entities.back(); // the entity is only a single index, copy it.
-			map_entity_componentID[entities.back()] = cID;
+			if (on_remove) on_remove(e, components[cID]);
 
 			// Erase the old component and free its memory
-			map_entity_componentID.erase(e);
-			components.pop_back();
-			entities.pop_back();
+			map.erase(it);
+			segments.remove(components, entities, e.scope(), cID, IndexUpdate{ this });
 			// Note, one could mark the id for re-use
 		}
 	};
@@ -110,9 +272,30 @@ public:
 	// Remove all components of type 'Component'
 	void clear()
 	{
-		map_entity_componentID.clear();
+		for (EntityMap<unsigned int>& map : map_entity_componentID)
+			map.clear();
 		components.clear();
 		entities.clear();
+		segments.clear();
+	}
+
+	// Remove the components of all entities of the scope, a single truncation for the room
+	void clear_scope(ENTITY_SCOPE scope)
+	{
+		if (on_remove) {
+			for (unsigned int i = segments.begin_of(scope); i < segments.end_of(scope); i++)
+				on_remove(entities[i], components[i]);
+		}
+		map_entity_componentID[(int)scope].clear();
+		segments.erase(components, entities, scope, IndexUpdate{ this });
+	}
+
+	// Make room for count components so inserting up to that many room components doesn't reallocate or rehash
+	void reserve(size_t count)
+	{
+		map_entity_componentID[(int)ENTITY_SCOPE::ROOM].reserve(count);
+		components.reserve(count);
+		entities.reserve(count);
 	}
 
 	// Report the number of components of type 'Component'
@@ -122,18 +305,20 @@ public:
 	}
 
 	// Sort the components and associated entity assignment structures by the comparisonFunction, see std::sort
+	// Every scope is sorted on its own, the components stay in their segments
 	template <class Compare>
 	void sort(Compare comparisonFunction)
 	{
 		// First sort the entity list as desired
-		std::sort(entities.begin(), entities.end(), comparisonFunction);
+		for (int scope = 0; scope < entity_scope_count; scope++)
+			std::sort(entities.begin() + segments.begin_of((ENTITY_SCOPE)scope), entities.begin() + segments.end_of((ENTITY_SCOPE)scope), comparisonFunction);
 		// Now re-arrange the components (Note, creates a new vector, which may be slow! Not sure if in-place could be faster: https://stackoverflow.com/questions/63703637/how-to-efficiently-permute-an-array-in-place-using-stdswap)
 		std::vector<Component> components_new; components_new.reserve(components.size());
 		std::transform(entities.begin(), entities.end(), std::back_inserter(components_new), [&](Entity e) { return std::move(get(e)); }); // note, the get still uses the old hash map (on purpose!)
 		components = std::move(components_new); // note, we use move operations to not create unneccesary copies of objects, but memory is still allocated for the new vector
 		// Fill the new hashmap
 		for (unsigned int i = 0; i < entities.size(); i++)
-			map_entity_componentID[entities[i]] = i;
+			map_of(entities[i])[entities[i]] = i;
 	}
 };
 
@@ -141,7 +326,17 @@ template<typename Component, unsigned int buckets>
 class BucketedComponentContainer : public ContainerInterface
 {
 private:
-	std::unordered_map<unsigned int, std::pair<unsigned int, unsigned int>> map_entity_componentID;
+	std::array<EntityMap<std::pair<unsigned int, unsigned int>>, entity_scope_count> map_entity_componentID;
+	// Every bucket is split into scopes on its own
+	std::array<ScopeSegments, buckets> segments;
+
+	EntityMap<std::pair<unsigned int, unsigned int>>& map_of(Entity e) { return map_entity_componentID[(int)e.scope()]; }
+
+	struct IndexUpdate {
+		BucketedComponentContainer* container;
+		unsigned int bucket;
+		void operator()(Entity e, unsigned int index) const { container->map_of(e)[e] = std::make_pair(bucket, index); }
+	};
 public:
 	std::array<std::vector<Component>, buckets> components;
 	std::array<std::vector<Entity>, buckets> entities;
@@ -153,10 +348,11 @@ public:
 	inline Component& insert(Entity e, Component c, unsigned int bucket, bool check_for_duplicates = true)
 	{
 		assert(!(check_for_duplicates && has(e)) && "Entity already contained in ECS registry");
-		map_entity_componentID[e] = std::make_pair(bucket, components[bucket].size());
 		components[bucket].push_back(std::move(c));
 		entities[bucket].push_back(e);
-		return components[bucket].back();
+		unsigned int index = segments[bucket].place_last(components[bucket], entities[bucket], e.scope(), IndexUpdate{ this, bucket });
+		map_of(e)[e] = std::make_pair(bucket, index);
+		return components[bucket][index];
 	};
 
 	template<typename... Args>
@@ -171,43 +367,61 @@ public:
 
 	Component& get(Entity e) {
 		assert(has(e) && "Entity not contained in ECS registry");
-		return components[map_entity_componentID[e].first][map_entity_componentID[e].second];
+		std::pair<unsigned int, unsigned int> position = map_of(e)[e];
+		return components[position.first][position.second];
 	}
 
 	bool has(Entity entity) {
-		return map_entity_componentID.count(entity) > 0;
+		return map_of(entity).count(entity) > 0;
 	}
 
 	void remove(Entity e)
 	{
-		if (has(e))
+		EntityMap<std::pair<unsigned int, unsigned int>>& map = map_of(e);
+		auto it = map.find(e);
+		if (it != map.end())
 		{
 			// Get the current position
-			unsigned int bucket_index = map_entity_componentID[e].first;
-			unsigned int component_index = map_entity_componentID[e].second;
-			// Move the last element to position cID using the move operator
-			// Note, components[cID] = components.back() would trigger the copy instead of move operator
-			components[bucket_index][component_index] = std::move(components[bucket_index].back());
-			entities[bucket_index][component_index] = entities[bucket_index].back(); // the entity is only a single index, copy it.
-			map_entity_componentID[entities[bucket_index].back()] = std::make_pair(bucket_index, component_index);
+			unsigned int bucket_index = it->second.first;
+			unsigned int component_index = it->second.second;
 
 			// Erase the old component and free its memory
-			map_entity_componentID.erase(e);
-			components[bucket_index].pop_back();
-			entities[bucket_index].pop_back();
+			map.erase(it);
+			segments[bucket_index].remove(components[bucket_index], entities[bucket_index], e.scope(), component_index, IndexUpdate{ this, bucket_index });
 			// Note, one could mark the id for re-use
 		}
 	};
 
 	void clear()
 	{
-		map_entity_componentID.clear();
+		for (auto& map : map_entity_componentID)
+			map.clear();
 		for (unsigned int i = 0; i < buckets; i++) {
 			components[i].clear();
 			entities[i].clear();
+			segments[i].clear();
 		}	
 	}
 
+	void clear_scope(ENTITY_SCOPE scope)
+	{
+		map_entity_componentID[(int)scope].clear();
+		for (unsigned int i = 0; i < buckets; i++)
+			segments[i].erase(components[i], entities[i], scope, IndexUpdate{ this, i });
+	}
+
+	// Make room for count components in one bucket, like ComponentContainer::reserve count is the total and not the number to add
+	// The map is shared by every bucket and grows by as many components as the bucket can
+	void reserve(unsigned int bucket, size_t count)
+	{
+		EntityMap<std::pair<unsigned int, unsigned int>>& map = map_entity_componentID[(int)ENTITY_SCOPE::ROOM];
+		size_t bucket_size = entities[bucket].size();
+		if (count > bucket_size)
+			map.reserve(map.size() + count - bucket_size);
+		components[bucket].reserve(count);
+		entities[bucket].reserve(count);
+	}
+
 	size_t size()
 	{
 		size_t size = 0;
@@ -1,3 +1,17 @@
 #include "tiny_ecs_registry.hpp"
 
-ECSRegistry registry;
\ No newline at end of file
+ECSRegistry registry;
+void remove_flock_member(Entity boid, FlockMember& member)
+{
+	if (!registry.flocks.has(member.flock)) return;
+
+	// Swap the last boid of the flock into the slot of the removed boid
+	auto& boids = registry.flocks.get(member.flock).boids;
+	assert(member.index < boids.size() && (unsigned int)boids[member.index] == (unsigned int)boid && "Flock member index out of date");
+	Entity last = boids.back();
+	boids[member.index] = last;
+	boids.pop_back();
+	if ((unsigned int)last != (unsigned int)boid) {
+		registry.flockMembers.get(last).index = member.index;
+	}
+}
@@ -4,6 +4,12 @@
 #include "tiny_ecs.hpp"
 #include "components.hpp"
 
+// Removes a destroyed boid from its flock, see ECSRegistry::flockMembers
+void remove_flock_member(Entity boid, FlockMember& member);
+
+// Frees the path of a destroyed spline bullet, see spline_arena.hpp
+void release_spline_curve(Entity entity, SplineBullet& spline);
+
 class ECSRegistry
 {
 	// Callbacks to remove a particular or all entities in the system
@@ -34,6 +40,7 @@ public:
 	ComponentContainer<Acceleration> accelerations;
 	ComponentContainer<Enemy> enemies;
 	ComponentContainer<Flock> flocks;
+	ComponentContainer<FlockMember> flockMembers;
 	ComponentContainer<Animation> animations;
 	ComponentContainer<DamageTimer> damageTimers;
 	ComponentContainer<Item> items;
@@ -59,6 +66,7 @@ public:
 	ComponentContainer<Victory> victories;
 	ComponentContainer<GunStatus> gunStatuses;
 	ComponentContainer<Rotate> rotates;
+	ComponentContainer<AiSchedule> aiSchedules;
 
 	// constructor that adds all containers for looping over them
 	// IMPORTANT: Don't forget to add any newly added containers!
@@ -86,6 +94,7 @@ public:
 		registry_list.push_back(&enemies);
 		registry_list.push_back(&doors);
 		registry_list.push_back(&flocks);
+		registry_list.push_back(&flockMembers);
 		registry_list.push_back(&particleSystems);
 		registry_list.push_back(&animations);
 		registry_list.push_back(&damageTimers);
@@ -112,6 +121,11 @@ public:
 		registry_list.push_back(&alerts);
 		registry_list.push_back(&gunStatuses);
 		registry_list.push_back(&rotates);
+		registry_list.push_back(&aiSchedules);
+
+		// Keep the boid list of every flock packed as boids are destroyed
+		flockMembers.on_remove = remove_flock_member;
+		splineBullets.on_remove = release_spline_curve;
 	}
 
 	void clear_all_components() {
@@ -119,6 +133,16 @@ public:
 			reg->clear();
 	}
 
+	// Drops every entity of the scope, e.g. the room when the player leaves it, with one clear per container
+	void clear_scope(ENTITY_SCOPE scope) {
+		for (ContainerInterface* reg : registry_list)
+			reg->clear_scope(scope);
+	}
+
+	const std::vector<ContainerInterface*>& all_containers() const {
+		return registry_list;
+	}
+
 	void list_all_components() {
 		printf("Debug info on all registry entries:\n");
 		for (ContainerInterface* reg : registry_list)
@@ -0,0 +1,30 @@
+// UI state handling, shared by the game and the headless build which has no ImGui
+#include "ui_system.hpp"
+
+UISystem::UISystem() {
+	state = UI_STATE_ID::MENU;
+}
+
+// Enters the given state
+// Some state combinations will produce undefined behavior
+void UISystem::enter_state(UI_STATE_ID state) {
+	this->state = (UI_STATE_ID)((int)this->state | (int)state);
+}
+
+// Exits the given state
+// Be sure that the UI will have a state even after this is called
+void UISystem::exit_state(UI_STATE_ID state) {
+	this->state = (UI_STATE_ID)((int)this->state & ~(int)state);
+}
+
+void UISystem::toggle_state(UI_STATE_ID state) {
+	this->state = (UI_STATE_ID)((int)this->state ^ (int)state);
+}
+
+bool UISystem::in_state(UI_STATE_ID state) {
+	return (int)this->state & (int)state;
+}
+
+bool UISystem::in_pause_state() {
+	return in_state(UI_STATE_ID::PAUSE) || in_state(UI_STATE_ID::CONTROLS) || in_state(UI_STATE_ID::MENU) || in_state(UI_STATE_ID::SCORE);
+}
@@ -1,16 +1,14 @@
 #include "ui_system.hpp"
 #include "tiny_ecs_registry.hpp"
 #include "world_init.hpp"
+#include "profiler.hpp"
+#include "alloc_tracker.hpp"
 
 #include <imgui_internal.h>
 #include <fstream>
 #include <iostream>
 #include <string>
 
-UISystem::UISystem() {
-	state = UI_STATE_ID::MENU;
-}
-
 bool UISystem::init(GLFWwindow* window) {
 	IMGUI_CHECKVERSION();
 	ImGui::CreateContext();
@@ -50,36 +48,13 @@ void UISystem::init_gun_textures() {
 	gun_textures[(int)GUN_ID::RAPID_SHOT] = textures[(GLuint)TEXTURE_ASSET_ID::RAPID_SHOT];
 }
 
-// Enters the given state
-// Some state combinations will produce undefined behavior
-void UISystem::enter_state(UI_STATE_ID state) {
-	this->state = (UI_STATE_ID)((int)this->state | (int)state);
-}
-
-// Exits the given state
-// Be sure that the UI will have a state even after this is called
-void UISystem::exit_state(UI_STATE_ID state) {
-	this->state = (UI_STATE_ID)((int)this->state & ~(int)state);
-}
-
-void UISystem::toggle_state(UI_STATE_ID state) {
-	this->state = (UI_STATE_ID)((int)this->state ^ (int)state);
-}
-
-bool UISystem::in_state(UI_STATE_ID state) {
-	return (int)this->state & (int)state;
-}
-
-bool UISystem::in_pause_state() {
-	return in_state(UI_STATE_ID::PAUSE) || in_state(UI_STATE_ID::CONTROLS) || in_state(UI_STATE_ID::MENU) || in_state(UI_STATE_ID::SCORE);
-}
-
 bool UISystem::wants_mouse_input() {
 	ImGuiIO& io = ImGui::GetIO();
 	return io.WantCaptureMouse;
 }
 
 void UISystem::render() {
+	PROFILE_SCOPE("UISystem::render");
 	ImGui_ImplOpenGL3_NewFrame();
 	ImGui_ImplGlfw_NewFrame();
 	ImGui::NewFrame();
@@ -153,6 +128,12 @@ void UISystem::render() {
 			registry.remove_all_components_of(registry.alerts.entities[i]);
 		}
 	}
+
+#ifndef PROFILER_DISABLED
+	if (profiler_visible) {
+		show_profiler();
+	}
+#endif
 	ImGui::Render();
 	if (resolutionScale != 1.0f) {
 		// Render to the actual window size
@@ -344,6 +325,32 @@ void UISystem::show_controls() {
 	ImGui::PopStyleColor(3);
 }
 
+// Breakdown of the last recorded frame, one row per zone indented by its depth
+void UISystem::show_profiler() {
+	const ProfileFrame* frame = profiler.last_frame();
+	ImGui::PushFont(fonts[(int)FONT_SIZE_ID::EXTRA_SMALL]);
+	ImGui::SetNextWindowPos(ImVec2(25, 150), ImGuiCond_FirstUseEver);
+	ImGui::Begin("Profiler", &profiler_visible, ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoFocusOnAppearing);
+	if (frame) {
+		bool allocs = alloc_tracking_enabled();
+		if (allocs)
+			ImGui::Text("Frame %lld: %.3f ms, %lld allocations", frame->index, (frame->end_ns - frame->start_ns) / 1e6, frame->allocs);
+		else
+			ImGui::Text("Frame %lld: %.3f ms", frame->index, (frame->end_ns - frame->start_ns) / 1e6);
+		ImGui::Separator();
+		for (const ProfileZone& zone : frame->zones) {
+			if (allocs)
+				ImGui::Text("%*s%-*s %8.3f ms %6lld", zone.depth * 2, "", 36 - zone.depth * 2, zone.name, (zone.end_ns - zone.start_ns) / 1e6, zone.allocs);
+			else
+				ImGui::Text("%*s%-*s %8.3f ms", zone.depth * 2, "", 36 - zone.depth * 2, zone.name, (zone.end_ns - zone.start_ns) / 1e6);
+		}
+		ImGui::Separator();
+		ImGui::Text("F9 saves the last %d frames as a Chrome trace", Profiler::frame_capacity);
+	}
+	ImGui::End();
+	ImGui::PopFont();
+}
+
 void UISystem::show_message(Message& message) {
 	ImGui::PushFont(fonts[(int)message.font_size]);
 	ImVec2 text_size = ImGui::CalcTextSize(message.message.c_str());
@@ -668,7 +675,7 @@ void UISystem::center_text(const char* text) {
 
 void createTitleScreenArt(RenderSystem* renderer, vec2 pos, float width, float height)
 {
-	auto entity = Entity();
+	auto entity = Entity(ENTITY_SCOPE::UI);
 
 	// Store a reference to the potentially re-used mesh object
 	Mesh& mesh = renderer->getMesh(GEOMETRY_BUFFER_ID::SPRITE);
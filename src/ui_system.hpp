@@ -22,6 +22,7 @@ public:
 
 	UI_STATE_ID state = UI_STATE_ID::PLAYING;
 	UI_BUTTON_ID pressed_button = UI_BUTTON_ID::NONE;
+	bool profiler_visible = false;
 	~UISystem();
 private:
 	
@@ -42,6 +43,7 @@ private:
 	void show_score();
 	void show_playing();
 	void show_controls();
+	void show_profiler();
 	void show_dialogue(Dialogue& dialogue);
 	void show_message(Message& message);
 	bool show_alert(Alert& alert);
@@ -1,61 +1,37 @@
 #include "world_init.hpp"
 #include "tiny_ecs_registry.hpp"
 #include "collisions.hpp"
+#include "bullet_system.hpp"
+#include "gun_table.hpp"
+#include "spline_arena.hpp"
+#include "prefabs.hpp"
+#include "spawn_queue.hpp"
+#include "small_vector.hpp"
+#include <algorithm>
+#include <cassert>
 #include <numeric>
 
 
 Gun createGun(GUN_ID gun_id) {
 	Gun gun;
 	gun.gun_id = gun_id;
-	if (gun_id == GUN_ID::STRAIGHT_SHOT) {
-		gun.cooldown_ms = 2000.f;
-	}
-	else if (gun_id == GUN_ID::SPLIT_SHOT) {
-		gun.cooldown_ms = 400.f;
-	}
-	else if (gun_id == GUN_ID::SPLINE_SHOT) {
-		gun.cooldown_ms = 2000.f;
-	}
-	else if (gun_id == GUN_ID::SPLIT_SPLINE_SHOT) {
-		gun.cooldown_ms = 2000.f;
-	}
-	else if (gun_id == GUN_ID::RAPID_SHOT) {
-		gun.cooldown_ms = 100.f;
-	}
-	else if (gun_id == GUN_ID::LONG_SHOT) {
-		gun.cooldown_ms = 1500.f;
-	}
-	else if (gun_id == GUN_ID::OMNI_SHOT) {
-		gun.cooldown_ms = 2000.f;
-	}
-	else if (gun_id == GUN_ID::ZAP_SHOT) {
-		gun.cooldown_ms = 1500.f;
-	}
-	else if (gun_id == GUN_ID::FIRE_SHOT) {
-		gun.cooldown_ms = 200.f;
-	}
-	else {
-		gun.cooldown_ms = 300.f;
-	}
+	gun.cooldown_ms = gunTable.get(gun_id, false).cooldown_ms;
 	return gun;
 }
 
 Gun& equipGun(Entity entity, GUN_ID gun_id) {
 	Gun gun = createGun(gun_id);
-	if (gun_id == GUN_ID::STRAIGHT_SHOT) {
-		if (registry.players.has(entity)) {
-			gun.cooldown_ms = 300.f;
-		}
-		else {
-			gun.cooldown_ms = 2000.f;
-		}
+	// The player's version of a gun can fire at its own rate
+	if (registry.players.has(entity)) {
+		gun.cooldown_ms = gunTable.get(gun_id, true).cooldown_ms;
 	}
 	return registry.guns.insert(entity, gun);
 }
 
 Entity createPlayer(RenderSystem* renderer, vec2 pos)
 {
-	auto entity = Entity();
+	// The player is carried from room to room
+	auto entity = Entity(ENTITY_SCOPE::PERSISTENT);
 
 	// // Store a reference to the potentially re-used mesh object
 	Mesh& mesh = renderer->getMesh(GEOMETRY_BUFFER_ID::ANIMATED_SPRITE);
@@ -80,7 +56,7 @@ Entity createPlayer(RenderSystem* renderer, vec2 pos)
 
 	// Create a collision mesh for the entity
 	// CollisionMesh collision_mesh = createEllipseCollisionMesh(entity, 10);
-	CollisionMesh collision_mesh = createMeshCollider(entity, "CharacterCollider-Scaled.obj");
+	CollisionMesh collision_mesh = createMeshCollider(entity, "CharacterCollider-scaled.obj");
 	//CollisionMesh collision_mesh = createCollisionMeshFromMesh(entity, )
 	collision_mesh.is_solid = true;
 	collision_mesh.is_static = false;
@@ -102,150 +78,51 @@ Entity createPlayer(RenderSystem* renderer, vec2 pos)
 	return entity;
 }
 
+// Zappers start at a random angle and spin in a random direction, the others keep the angle of their prefab
+static void planRotation(RandomStream& random, PlannedEnemy& enemy) {
+	const EnemyPrefab& prefab = prefabTable.enemy(enemy.id);
+	enemy.angle = prefab.motion.angle;
+	if (prefab.random_rotation) {
+		float rotation = (float)random.range(0, 6282); // 2PI * 1000 (because integer)
+		enemy.angle = rotation / 1000.0f;
+		enemy.rotate_direction = random.range(0, 99) > 50;
+	}
+}
+
 Entity createEnemy(RenderSystem* renderer, vec2 position, vec2 velocity, ENEMY_ID id, bool summoned)
 {
-	auto entity = Entity();
-
-	// Store a reference to the potentially re-used mesh object (the value is stored in the resource cache)
-	Mesh& mesh = renderer->getMesh(GEOMETRY_BUFFER_ID::ANIMATED_SPRITE);
-	registry.meshPtrs.emplace(entity, &mesh);
-
-	auto& motion = registry.motions.emplace(entity);
-	motion.velocity = velocity;
-	motion.position = position;
-	motion.angle = M_PI;
-
-	Animation& animation = registry.animations.emplace(entity);
-	animation.frame = 0;
-
-	Enemy& enemy = registry.enemies.emplace(entity);
+	PlannedEnemy enemy;
 	enemy.id = id;
+	enemy.position = position;
+	enemy.velocity = velocity;
+	planRotation(randomService.stream(RNG_STREAM::SPAWNS), enemy);
+	return createEnemy(renderer, enemy, summoned);
+}
 
-	// This doesn't have entity specific scaling, it's weird but I'm leaving it as an error catcher.
-	CollisionMesh collision_mesh = createEllipseCollisionMesh(entity, 10);
-
-	if (id == ENEMY_ID::NORMAL) {
-		motion.scale = mesh.original_size * 70.f;
-		animation.row = 4;
-		animation.num_frames = 4;
-		animation.speed = 100.f;
-
-		enemy.health = 30.f;
-		enemy.max_health = 30.f;
-		enemy.coin_drop = 25.f;
-
-		collision_mesh = createMeshCollider(entity, "EnemyNeutral-Scaled.obj");
-		collision_mesh.is_solid = true;
-		collision_mesh.is_static = false;
-	} else if (id == ENEMY_ID::ELITE) {
-		motion.scale = mesh.original_size * 120.f;
-		animation.row = 15;
-		animation.num_frames = 4;
-		animation.speed = 100.f;
-
-		enemy.health = 90.f;
-		enemy.max_health = 90.f;
-		enemy.coin_drop = 50.f;
-
-		collision_mesh = createMeshCollider(entity, "EnemyElite.obj");
-		collision_mesh.is_solid = true;
-		collision_mesh.is_static = false;
-	} else if (id == ENEMY_ID::BOMBER) {
-		motion.scale = mesh.original_size * 120.f;
-		motion.angle = M_PI/2;
-		animation.row = 32;
-		animation.num_frames = 4;
-		animation.speed = 100.f;
-
-		enemy.health = 70.f;
-		enemy.max_health = 70.f;
-		enemy.coin_drop = 30.f;
-
-		collision_mesh = createMeshCollider(entity, "BombMesh.obj");
-		collision_mesh.is_solid = true;
-		collision_mesh.is_static = false;
-	}
-	else if (id == ENEMY_ID::DUMMY) {
-		motion.position = position;
-		//motion.angle = M_PI / 2;
-		motion.angle = -M_PI / 2;
-		motion.scale = mesh.original_size * 110.f;
-		//motion.scale.y *= -1;
-		animation.row = 19;
-		animation.num_frames = 1;
-		animation.speed = 100.f;
+Entity createEnemy(RenderSystem*, const PlannedEnemy& planned, bool summoned)
+{
+	auto entity = Entity();
+	const EnemyPrefab& prefab = prefabTable.enemy(planned.id);
 
-		enemy.health = 100.f;
-		enemy.max_health = 100.f;
-		enemy.coin_drop = 100.f;
+	// Store a reference to the potentially re-used mesh object (the value is stored in the resource cache)
+	registry.meshPtrs.emplace(entity, prefab.mesh);
 
-		collision_mesh = createMeshCollider(entity, "DummyCollider-Rotated.obj");
-		collision_mesh.is_solid = true;
-		collision_mesh.is_static = true;
-	}
-	else if (id == ENEMY_ID::ZAPPER) {
-		motion.scale = mesh.original_size * 90.f;
+	Motion& motion = registry.motions.insert(entity, prefab.motion);
+	motion.velocity = planned.velocity;
+	motion.position = planned.position;
+	motion.angle = planned.angle;
 
-		float rotation = rand() % 6283; // 2PI * 1000 (because integer)
-		motion.angle = rotation / 1000.0f;
+	if (prefab.random_rotation) {
 		Rotate& rotate = registry.rotates.emplace(entity);
-		if (rand() % 100 > 50) {
-			rotate.direction = true;
-		}
-		else {
-			rotate.direction = false;
-		}
-
-		animation.row = 34;
-		animation.num_frames = 6;
-		animation.speed = 100.f;
-
-		enemy.health = 100.f;
-		enemy.max_health = 100.f;
-		enemy.coin_drop = 75.f;
-
-		collision_mesh = createMeshCollider(entity, "ZapperMesh.obj");
-		collision_mesh.is_solid = true;
-		collision_mesh.is_static = false;
-	}
-	else if (id == ENEMY_ID::FLAMETHROWER) {
-		motion.scale = mesh.original_size * 100.f;
-		animation.row = 36;
-		animation.num_frames = 2;
-		animation.speed = 200.f;
-
-		enemy.health = 40.f;
-		enemy.max_health = 40.f;
-		enemy.coin_drop = 50.f;
-
-		collision_mesh = createMeshCollider(entity, "FlamethrowerMesh.obj");
-		collision_mesh.is_solid = true;
-		collision_mesh.is_static = false;
+		rotate.direction = planned.rotate_direction;
 	}
 
-	registry.collisionMeshes.insert(entity, collision_mesh);
-
-	registry.renderRequests.insert(
-		entity,
-		{ TEXTURE_ASSET_ID::SPRITESHEET,
-		 EFFECT_ASSET_ID::ANIMATED,
-		 GEOMETRY_BUFFER_ID::ANIMATED_SPRITE},
-		(unsigned int)RENDER_LAYER_ID::MIDGROUND_FAR);
-
-	if (id == ENEMY_ID::NORMAL) {
-		equipGun(entity, GUN_ID::STRAIGHT_SHOT).is_firing = true;
-	}
-	else if (id == ENEMY_ID::ELITE) {
-		equipGun(entity, GUN_ID::SPLINE_SHOT).is_firing = true;
-	}
-	else if (id == ENEMY_ID::ZAPPER) {
-		equipGun(entity, GUN_ID::ZAP_SHOT).is_firing = true;
-	}
-	else if (id == ENEMY_ID::FLAMETHROWER) {
-		equipGun(entity, GUN_ID::FIRE_SHOT).is_firing = true;
-	}
-	else if (id == ENEMY_ID::BOMBER) {
-		equipGun(entity, GUN_ID::EXPLOSION_SHOT).is_firing = false;
+	Animation& animation = registry.animations.insert(entity, prefab.animation);
+	registry.enemies.insert(entity, prefab.enemy);
+	registry.collisionMeshes.insert(entity, prefab.collision_mesh);
+	registry.renderRequests.insert(entity, prefab.render_request, (unsigned int)RENDER_LAYER_ID::MIDGROUND_FAR);
+	if (prefab.has_gun) {
+		registry.guns.insert(entity, prefab.gun).timer_ms = planned.gun_timer_ms;
 	}
 
 	if (summoned) {
@@ -261,24 +138,18 @@ Entity createEnemy(RenderSystem* renderer, vec2 position, vec2 velocity, ENEMY_I
 Entity createBoss(RenderSystem* renderer, vec2 position, vec2 velocity, int coins)
 {
 	auto entity = Entity();
+	const BossPrefab& prefab = prefabTable.boss();
 
 	// Store a reference to the potentially re-used mesh object (the value is stored in the resource cache)
-	Mesh& mesh = renderer->getMesh(GEOMETRY_BUFFER_ID::BOSS_SPRITE);
-	registry.meshPtrs.emplace(entity, &mesh);
+	registry.meshPtrs.emplace(entity, prefab.mesh);
 
-	auto& motion = registry.motions.emplace(entity);
+	Motion& motion = registry.motions.insert(entity, prefab.motion);
 	motion.velocity = velocity;
 	motion.position = position;
-	motion.angle = M_PI;
-	motion.scale = mesh.original_size * 500.f;
 
-	Animation& animation = registry.animations.emplace(entity);
-	animation.frame = 0;
-	animation.row = 4;
-	animation.num_frames = 4;
-	animation.speed = 100.f;
+	registry.animations.insert(entity, prefab.animation);
 
-	Boss& boss = registry.bosses.emplace(entity);
+	Boss& boss = registry.bosses.insert(entity, prefab.boss);
 	float new_health;
 	float new_coins;
 	if (coins < 100) {
@@ -299,22 +170,9 @@ Entity createBoss(RenderSystem* renderer, vec2 position, vec2 velocity, int coin
 		boss.coin_drop = boss.max_drop;
 	}
 
-	// Create a collision mesh for the entity
-	// CollisionMesh collision_mesh = createEllipseCollisionMesh(entity, 10);
-	CollisionMesh collision_mesh = createMeshCollider(entity, "BossCollider-Triangulated.obj");
-	collision_mesh.is_solid = true;
-	collision_mesh.is_static = true;
-
-	registry.collisionMeshes.insert(entity, collision_mesh);
-
-	registry.renderRequests.insert(
-		entity,
-		{ TEXTURE_ASSET_ID::BOSS,
-		 EFFECT_ASSET_ID::BOSS_ANIMATE,
-		 GEOMETRY_BUFFER_ID::BOSS_SPRITE },
-		(unsigned int)RENDER_LAYER_ID::MIDGROUND_FAR);
-
-	equipGun(entity, GUN_ID::SPLIT_SPLINE_SHOT).is_firing = false;
+	registry.collisionMeshes.insert(entity, prefab.collision_mesh);
+	registry.renderRequests.insert(entity, prefab.render_request, (unsigned int)RENDER_LAYER_ID::MIDGROUND_FAR);
+	registry.guns.insert(entity, prefab.gun);
 	boss.max_health = boss.health;
 
 	registry.introTimers.emplace(entity);
@@ -338,7 +196,7 @@ Entity createSplineBullet(vec2 start_pos, vec2 end_pos, float angle, float speed
 	CollisionMesh collision_mesh = createEllipseCollisionMesh(entity, 8);
 	collision_mesh.is_solid = true;
 	collision_mesh.is_static = false;
-	registry.collisionMeshes.insert(entity, collision_mesh);
+	registry.collisionMeshes.insert(entity, std::move(collision_mesh));
 
 	Projectile& proj = registry.projectiles.emplace(entity);
 	proj.can_richochet = false;
@@ -374,294 +232,258 @@ Entity createSplineBullet(vec2 start_pos, vec2 end_pos, float angle, float speed
 		});
 
 	// Create spline movement from start pos to end pos
-	SplineBullet& spline = registry.splineBullets.emplace(entity);
 	float distance_bw = glm::distance(start_pos, end_pos);
 	vec2 direction = glm::normalize(end_pos - start_pos);
 	vec2 normal = { -direction.y, direction.x };
-	std::random_device rd;
-	std::mt19937 gen(rd());
-	std::uniform_real_distribution<float> direction_distribution(-1, 1);
-	std::uniform_real_distribution<float> distance_distribution(0.2, 1);
-	float random_direction = direction_distribution(gen);
-	float random_distance = distance_distribution(gen);
-	vec2 control_point_1 = start_pos + (random_distance * distance_bw / 2.f * direction) + (random_direction * distance_bw * normal);
-	
-
-	int num_points = 20;
-	float t_step = 1.f / (num_points - 1);
-	float t = 0.f;
-	float distance = 0.f;
-	int point_number = 0;
-	while (t <= 1.f) {
-		vec2 p = catmullrom(start_pos, control_point_1, end_pos, end_pos, t);
-		spline.points_on_line.push_back(p);
-		t += t_step;
-		if (point_number > 0) {
-			distance += glm::distance(spline.points_on_line[point_number - 1], spline.points_on_line[point_number]);
-		}
-		point_number++;
+	RandomStream& random = randomService.stream(RNG_STREAM::GUNS);
+	float random_direction = random.uniform(-1.f, 1.f);
+	float random_distance = random.uniform(0.2f, 1.f);
+	// A shooter right on top of its target fires straight
+	if (distance_bw > 0.f) {
+		vec2 control_point_1 = start_pos + (random_distance * distance_bw / 2.f * direction) + (random_direction * distance_bw * normal);
+		SplineBullet& spline = registry.splineBullets.emplace(entity);
+		spline.curve = splineArena.add(start_pos, control_point_1, end_pos);
+		spline.total_distance = splineArena.length(spline.curve);
 	}
 
-	spline.total_distance = distance;
-
 	return entity;
 }
 
-vec2 catmullrom(vec2 p0, vec2 p1, vec2 p2, vec2 p3, float t) {
-	float t2 = t * t;
-	float t3 = t2 * t;
-
-	vec2 v0 = (p2 - p0) * 0.5f;
-	vec2 v1 = (p3 - p1) * 0.5f;
+// Draws the position before the velocity, argument evaluation order would differ between compilers
+void randomSpawn(RandomStream& random, vec2 spawnMin, vec2 spawnMax, vec2& position, vec2& velocity) {
+	position.x = random.uniform(spawnMin.x, spawnMax.x);
+	position.y = random.uniform(spawnMin.y, spawnMax.y);
+	velocity.x = random.uniform(-5.f, 5.f);
+	velocity.y = random.uniform(-5.f, 5.f);
+}
 
-	float a1 = 2 * t3 - 3 * t2 + 1;
-	float a2 = t3 - 2 * t2 + t;
-	float a3 = -2 * t3 + 3 * t2;
-	float a4 = t3 - t2;
+void addToFlock(Entity flock, Entity boid) {
+	Flock& flockComponent = registry.flocks.get(flock);
+	FlockMember& member = registry.flockMembers.emplace(boid);
+	member.flock = flock;
+	member.index = (unsigned int)flockComponent.boids.size();
+	flockComponent.boids.push_back(boid);
+}
 
-	return a1 * p1 + a2 * v0 + a3 * p2 + a4 * v1;
+// Spawns one planned enemy through the spawn queue
+// The AI removes flocks without boids, a flock whose boids are still queued is created again by the first of them
+static void spawnPlannedEnemy(RenderSystem* renderer, Entity flock, Entity target, const PlannedEnemy& enemy, bool summoned) {
+	spawnQueue.push([=]() {
+		Entity entity = createEnemy(renderer, enemy, summoned);
+		if (enemy.in_flock) {
+			if (!registry.flocks.has(flock))
+				registry.flocks.emplace(flock).target = target;
+			addToFlock(flock, entity);
+		}
+	});
 }
 
-Entity createEasySwarm(RenderSystem* renderer, Entity target, vec2 spawnMin, vec2 spawnMax, int count, bool summoned) {
-	std::random_device rd;
-	std::mt19937 gen(rd());
-	std::uniform_real_distribution<float> xDistribution(spawnMin.x, spawnMax.x);
-	std::uniform_real_distribution<float> yDistribution(spawnMin.y, spawnMax.y);
-	std::uniform_real_distribution<float> velocityDistribution(-5.f, 5.f);
+Entity createFlock(Entity target, int count) {
 	auto flock = Entity();
-	registry.flocks.emplace(flock);
-	auto& flockComponent = registry.flocks.get(flock);
+	Flock& flockComponent = registry.flocks.emplace(flock);
 	flockComponent.target = target;
+	prefabTable.reserve_enemies(count);
+	flockComponent.boids.reserve(count);
+	return flock;
+}
 
-	for (int i = 0; i < count; i++) {
-		std::random_device rd;
-		std::mt19937 gen(rd());
-		std::uniform_int_distribution<int> distribution(0, 3);
-		int enemy_id = distribution(gen);
+void spawnPlannedEnemies(RenderSystem* renderer, Entity target, const std::vector<PlannedEnemy>& enemies) {
+	prefabTable.reserve_enemies(enemies.size());
+	// Flocks are created when the first of their enemies comes up, the same order as spawning swarm after swarm
+	SmallVector<Entity, 4> flocks;
+	for (const PlannedEnemy& enemy : enemies) {
+		if (enemy.swarm < 0) {
+			spawnQueue.push([=]() { createEnemy(renderer, enemy, false); });
+			continue;
+		}
+		assert(enemy.swarm <= (int)flocks.size() && "Swarms are numbered in the order they are planned");
+		if (enemy.swarm == (int)flocks.size()) {
+			int count = (int)std::count_if(enemies.begin(), enemies.end(), [&](const PlannedEnemy& other) { return other.swarm == enemy.swarm; });
+			flocks.push_back(createFlock(target, count));
+		}
+		spawnPlannedEnemy(renderer, flocks[enemy.swarm], target, enemy, false);
+	}
+}
 
-		ENEMY_ID id = ENEMY_ID::NORMAL;
+// Creates the flock of a swarm planned from the spawn stream and spawns its enemies, right away or over the room transition while it is staged
+static Entity spawnSwarm(RenderSystem* renderer, Entity target, const std::vector<PlannedEnemy>& enemies, bool summoned) {
+	Entity flock = createFlock(target, (int)enemies.size());
+	for (const PlannedEnemy& enemy : enemies)
+		spawnPlannedEnemy(renderer, flock, target, enemy, summoned);
+	return flock;
+}
+
+// Plans one enemy of a swarm, its gun starts at a random point of the cooldown
+static void planSwarmEnemy(RandomStream& random, vec2 spawnMin, vec2 spawnMax, ENEMY_ID id, int swarm, bool in_flock, std::vector<PlannedEnemy>& enemies) {
+	PlannedEnemy enemy;
+	enemy.id = id;
+	randomSpawn(random, spawnMin, spawnMax, enemy.position, enemy.velocity);
+	enemy.swarm = swarm;
+	enemy.in_flock = in_flock;
+	planRotation(random, enemy);
+	const EnemyPrefab& prefab = prefabTable.enemy(id);
+	if (prefab.has_gun)
+		enemy.gun_timer_ms = random.uniform(0.f, prefab.gun.cooldown_ms);
+	enemies.push_back(enemy);
+}
 
-		auto entity = createEnemy(renderer, vec2(xDistribution(gen), yDistribution(gen)), vec2(velocityDistribution(gen), velocityDistribution(gen)), id, summoned);
-		flockComponent.boids.push_back(entity);
-		Gun& gun = registry.guns.get(entity);
-		std::uniform_real_distribution<float> gunDistribution(0, gun.cooldown_ms);
-		gun.timer_ms = gunDistribution(gen);
+void planEasySwarm(RandomStream& random, vec2 spawnMin, vec2 spawnMax, int count, int swarm, std::vector<PlannedEnemy>& enemies) {
+	for (int i = 0; i < count; i++) {
+		ENEMY_ID id = ENEMY_ID::NORMAL;
+		planSwarmEnemy(random, spawnMin, spawnMax, id, swarm, true, enemies);
 	}
-	return flock;
 }
 
-Entity createSwarm(RenderSystem* renderer, Entity target, vec2 spawnMin, vec2 spawnMax, int count, int maxElite, bool summoned) {
-	std::random_device rd;
-	std::mt19937 gen(rd());
-	std::uniform_real_distribution<float> xDistribution(spawnMin.x, spawnMax.x);
-	std::uniform_real_distribution<float> yDistribution(spawnMin.y, spawnMax.y);
-	std::uniform_real_distribution<float> velocityDistribution(-5.f, 5.f);
-	auto flock = Entity();
-	registry.flocks.emplace(flock);
-	auto& flockComponent = registry.flocks.get(flock);
-	flockComponent.target = target;
+Entity createEasySwarm(RenderSystem* renderer, Entity target, vec2 spawnMin, vec2 spawnMax, int count, bool summoned) {
+	std::vector<PlannedEnemy> enemies;
+	planEasySwarm(randomService.stream(RNG_STREAM::SPAWNS), spawnMin, spawnMax, count, 0, enemies);
+	return spawnSwarm(renderer, target, enemies, summoned);
+}
+
+void planSwarm(RandomStream& random, vec2 spawnMin, vec2 spawnMax, int count, int maxElite, int swarm, std::vector<PlannedEnemy>& enemies) {
 	int eliteCount = 0;
 	for (int i = 0; i < count; i++) {
-		std::random_device rd;
-		std::mt19937 gen(rd());
-		std::uniform_int_distribution<int> distribution(0, 3);
-		int enemy_id = distribution(gen);
+		int enemy_id = random.range(0, 3);
 
 		ENEMY_ID id = ENEMY_ID::NORMAL;
 
 		if ((enemy_id == 0 && eliteCount < maxElite) || eliteCount == 0) {
-			std::random_device rd;
-			std::mt19937 gen(rd());
-			std::uniform_int_distribution<int> distribution(0, 2);
-			int type = distribution(gen);
 			id = ENEMY_ID::ELITE;
 			eliteCount++;
 		}
 
-		auto entity = createEnemy(renderer, vec2(xDistribution(gen), yDistribution(gen)), vec2(velocityDistribution(gen), velocityDistribution(gen)), id, summoned);
-		flockComponent.boids.push_back(entity);
-		Gun& gun = registry.guns.get(entity);
-		std::uniform_real_distribution<float> gunDistribution(0, gun.cooldown_ms);
-		gun.timer_ms = gunDistribution(gen);
+		planSwarmEnemy(random, spawnMin, spawnMax, id, swarm, true, enemies);
 	}
-	return flock;
+}
+
+Entity createSwarm(RenderSystem* renderer, Entity target, vec2 spawnMin, vec2 spawnMax, int count, int maxElite, bool summoned) {
+	std::vector<PlannedEnemy> enemies;
+	planSwarm(randomService.stream(RNG_STREAM::SPAWNS), spawnMin, spawnMax, count, maxElite, 0, enemies);
+	return spawnSwarm(renderer, target, enemies, summoned);
 }
 
 // ChatGPT Weighted Selection
-std::size_t weightedSelection(const std::vector<double>& weights) {
+static std::size_t weightedSelection(RandomStream& random, const double* weights, std::size_t count) {
 	// Calculate the cumulative distribution function (CDF)
-	std::vector<double> cdf(weights.size());
-	std::partial_sum(weights.begin(), weights.end(), cdf.begin());
+	double cdf[enemy_type_count];
+	std::partial_sum(weights, weights + count, cdf);
 
 	// Generate a random value between 0 and the total weight
-	std::random_device rd;
-	std::mt19937 gen(rd());
-	std::uniform_real_distribution<double> dis(0.0, cdf.back());
+	double value = random.uniform_double(0.0, cdf[count - 1]);
 
 	// Perform binary search on the CDF to find the selected index
-	auto it = std::upper_bound(cdf.begin(), cdf.end(), dis(gen));
-	return std::distance(cdf.begin(), it);
+	auto it = std::upper_bound(cdf, cdf + count, value);
+	return std::distance(cdf, it);
 }
 
 // ChatGPT
 // Function to normalize a vector of weights
-void normalizeWeights(std::vector<double>& weights) {
-	double sum = std::accumulate(weights.begin(), weights.end(), 0.0);
+static void normalizeWeights(double* weights, std::size_t count) {
+	double sum = std::accumulate(weights, weights + count, 0.0);
 
 	if (sum != 0.0) {
-		std::transform(weights.begin(), weights.end(), weights.begin(),
+		std::transform(weights, weights + count, weights,
 			[sum](double w) { return w / sum; });
 	}
 }
 
-Entity createMegaSwarm(RenderSystem* renderer, Entity target, vec2 spawnMin, vec2 spawnMax, int coins, int roomsCleared, bool summoned) {
-	std::random_device rd;
-	std::mt19937 gen(rd());
-	std::uniform_real_distribution<float> xDistribution(spawnMin.x, spawnMax.x);
-	std::uniform_real_distribution<float> yDistribution(spawnMin.y, spawnMax.y);
-	std::uniform_real_distribution<float> velocityDistribution(-5.f, 5.f);
-	Entity flock = Entity();
-	registry.flocks.emplace(flock);
-	Flock& flockComponent = registry.flocks.get(flock);
-	flockComponent.target = target;
-
-	int denominator = (rand() % 5) + 70;
+void planMegaSwarm(RandomStream& random, vec2 spawnMin, vec2 spawnMax, int coins, int roomsCleared, int swarm, std::vector<PlannedEnemy>& enemies) {
+	int denominator = random.range(0, 4) + 70;
 	int count = coins / denominator;
 	if (count < 4) count = 4;
 	if (count > 9) count = 9;
 
 	// setup weights here
 	// ORDER IS: NORMAL, SPLINE, DUMMY, ZAPPER, FLAMETHROWER, BOMBER
-	std::vector<double> weights = std::vector<double>();
+	double weights[enemy_type_count];
 
-	weights.push_back(max(25, 750 - coins)); // NORMAL
-	weights.push_back(max(20, 500 - coins)); // SPLINE
-	weights.push_back(0.0); // DUMMY
+	weights[0] = max(25, 750 - coins); // NORMAL
+	weights[1] = max(20, 500 - coins); // SPLINE
+	weights[2] = 0.0; // DUMMY
 
 	double zapperWeight = 0;
 	if (roomsCleared < 5) zapperWeight = 0;
 	if (roomsCleared == 5) zapperWeight = 300;
 	if (roomsCleared > 5) zapperWeight = 150;
-	weights.push_back(zapperWeight); // ZAPPER
+	weights[3] = zapperWeight; // ZAPPER
 
-	double flamethrowers = rand() % 3 <= 1 ? 1 : 0;
+	double flamethrowers = random.range(0, 2) <= 1 ? 1 : 0;
 	double flamethrowerWeight = 200 * flamethrowers;
 
-	weights.push_back(flamethrowerWeight); // FLAMETHROWER
+	weights[4] = flamethrowerWeight; // FLAMETHROWER
 
-	weights.push_back(min(max(15, coins / 3), 150)); // BOMBER
+	weights[5] = min(max(15, coins / 3), 150); // BOMBER
 
-	normalizeWeights(weights);
+	normalizeWeights(weights, enemy_type_count);
 
 	int difficultyBudget = 25 * roomsCleared;
 	// ORDER IS: NORMAL, SPLINE, DUMMY, ZAPPER, FLAMETHROWER, BOMBER
 	int costs[] = {0,	 5,		 10000, 75,		30,			  35};
 
-	printf("Spawn Weights are:\n");
-	for (int i = 0; i < weights.size(); i++)
-	{
-		printf("  %d: %f\n", i, weights[i]);
-	}
-	printf("Difficulty Budget: %d\n", difficultyBudget);
-	printf("Rooms cleared: %d, coins: %d\n", roomsCleared, coins);
-
 	for (int i = 0; i < count; i++) {
 		ENEMY_ID id = ENEMY_ID::NORMAL;
 
 		if (difficultyBudget > 0)
 		{
-			id = (ENEMY_ID)weightedSelection(weights);
+			id = (ENEMY_ID)weightedSelection(random, weights, enemy_type_count);
 
 			difficultyBudget -= costs[(int)id];
 		}
 
-		Entity entity = createEnemy(renderer, vec2(xDistribution(gen), yDistribution(gen)), vec2(velocityDistribution(gen), velocityDistribution(gen)), id, summoned);
-		if (id != ENEMY_ID::BOMBER)
-		{
-			flockComponent.boids.push_back(entity);
-		}
-		Gun& gun = registry.guns.get(entity);
-		std::uniform_real_distribution<float> gunDistribution(0, gun.cooldown_ms);
-		gun.timer_ms = gunDistribution(gen);
+		planSwarmEnemy(random, spawnMin, spawnMax, id, swarm, id != ENEMY_ID::BOMBER, enemies);
 	}
-	return flock;
 }
 
-Entity createFlameThrowerSwarm(RenderSystem* renderer, Entity target, vec2 spawnMin, vec2 spawnMax, int count, bool summoned) {
-	std::random_device rd;
-	std::mt19937 gen(rd());
-	std::uniform_real_distribution<float> xDistribution(spawnMin.x, spawnMax.x);
-	std::uniform_real_distribution<float> yDistribution(spawnMin.y, spawnMax.y);
-	std::uniform_real_distribution<float> velocityDistribution(-5.f, 5.f);
-	auto flock = Entity();
-	registry.flocks.emplace(flock);
-	auto& flockComponent = registry.flocks.get(flock);
-	flockComponent.target = target;
-	Entity output;
+Entity createMegaSwarm(RenderSystem* renderer, Entity target, vec2 spawnMin, vec2 spawnMax, int coins, int roomsCleared, bool summoned) {
+	std::vector<PlannedEnemy> enemies;
+	planMegaSwarm(randomService.stream(RNG_STREAM::SPAWNS), spawnMin, spawnMax, coins, roomsCleared, 0, enemies);
+	return spawnSwarm(renderer, target, enemies, summoned);
+}
 
+void planFlameThrowerSwarm(RandomStream& random, vec2 spawnMin, vec2 spawnMax, int count, int swarm, std::vector<PlannedEnemy>& enemies) {
 	for (int i = 0; i < count; i++) {
-		std::random_device rd;
-		std::mt19937 gen(rd());
-		std::uniform_int_distribution<int> distribution(0, 3);
-		int enemy_id = distribution(gen);
 		ENEMY_ID id = ENEMY_ID::FLAMETHROWER;
-
-		auto entity = createEnemy(renderer, vec2(xDistribution(gen), yDistribution(gen)), vec2(velocityDistribution(gen), velocityDistribution(gen)), id, summoned);
-		flockComponent.boids.push_back(entity);
-		Gun& gun = registry.guns.get(entity);
-		std::uniform_real_distribution<float> gunDistribution(0, gun.cooldown_ms);
-		gun.timer_ms = gunDistribution(gen);
-
-		output = entity;
+		planSwarmEnemy(random, spawnMin, spawnMax, id, swarm, true, enemies);
 	}
+}
 
-	return flock;
+Entity createFlameThrowerSwarm(RenderSystem* renderer, Entity target, vec2 spawnMin, vec2 spawnMax, int count, bool summoned) {
+	std::vector<PlannedEnemy> enemies;
+	planFlameThrowerSwarm(randomService.stream(RNG_STREAM::SPAWNS), spawnMin, spawnMax, count, 0, enemies);
+	return spawnSwarm(renderer, target, enemies, summoned);
 }
 
-Entity createZapperSwarm(RenderSystem* renderer, Entity target, vec2 spawnMin, vec2 spawnMax, int count, bool summoned) {
-	std::random_device rd;
-	std::mt19937 gen(rd());
-	std::uniform_real_distribution<float> xDistribution(spawnMin.x, spawnMax.x);
-	std::uniform_real_distribution<float> yDistribution(spawnMin.y, spawnMax.y);
-	std::uniform_real_distribution<float> velocityDistribution(-5.f, 5.f);
-	auto flock = Entity();
-	registry.flocks.emplace(flock);
-	auto& flockComponent = registry.flocks.get(flock);
-	flockComponent.target = target;
+void planZapperSwarm(RandomStream& random, vec2 spawnMin, vec2 spawnMax, int count, int swarm, std::vector<PlannedEnemy>& enemies) {
 	for (int i = 0; i < count; i++) {
-		std::random_device rd;
-		std::mt19937 gen(rd());
-		std::uniform_int_distribution<int> distribution(0, 3);
-		int enemy_id = distribution(gen);
 		ENEMY_ID id = ENEMY_ID::ZAPPER;
-
-		auto entity = createEnemy(renderer, vec2(xDistribution(gen), yDistribution(gen)), vec2(velocityDistribution(gen), velocityDistribution(gen)), id, summoned);
-		flockComponent.boids.push_back(entity);
-		Gun& gun = registry.guns.get(entity);
-		std::uniform_real_distribution<float> gunDistribution(0, gun.cooldown_ms);
-		gun.timer_ms = gunDistribution(gen);
+		planSwarmEnemy(random, spawnMin, spawnMax, id, swarm, true, enemies);
 	}
-	return flock;
 }
 
-void createBombers(RenderSystem* renderer, Entity target, vec2 spawnMin, vec2 spawnMax, int count, bool summoned) {
-	std::random_device rd;
-	std::mt19937 gen(rd());
-	std::uniform_real_distribution<float> xDistribution(spawnMin.x, spawnMax.x);
-	std::uniform_real_distribution<float> yDistribution(spawnMin.y, spawnMax.y);
-	std::uniform_real_distribution<float> velocityDistribution(-5.f, 5.f);
+Entity createZapperSwarm(RenderSystem* renderer, Entity target, vec2 spawnMin, vec2 spawnMax, int count, bool summoned) {
+	std::vector<PlannedEnemy> enemies;
+	planZapperSwarm(randomService.stream(RNG_STREAM::SPAWNS), spawnMin, spawnMax, count, 0, enemies);
+	return spawnSwarm(renderer, target, enemies, summoned);
+}
 
+void planBombers(RandomStream& random, vec2 spawnMin, vec2 spawnMax, int count, std::vector<PlannedEnemy>& enemies) {
 	for (int i = 0; i < count; i++) {
-		std::random_device rd;
-		std::mt19937 gen(rd());
-		std::uniform_int_distribution<int> distribution(0, 3);
-		int enemy_id = distribution(gen);
-		ENEMY_ID id = ENEMY_ID::BOMBER;
-
-		auto entity = createEnemy(renderer, vec2(xDistribution(gen), yDistribution(gen)), vec2(velocityDistribution(gen), velocityDistribution(gen)), id, summoned);
+		PlannedEnemy enemy;
+		enemy.id = ENEMY_ID::BOMBER;
+		randomSpawn(random, spawnMin, spawnMax, enemy.position, enemy.velocity);
+		planRotation(random, enemy);
+		enemies.push_back(enemy);
 	}
 }
 
+void createBombers(RenderSystem* renderer, Entity, vec2 spawnMin, vec2 spawnMax, int count, bool summoned) {
+	prefabTable.reserve_enemies(count);
+	std::vector<PlannedEnemy> enemies;
+	planBombers(randomService.stream(RNG_STREAM::SPAWNS), spawnMin, spawnMax, count, enemies);
+	for (const PlannedEnemy& enemy : enemies)
+		spawnQueue.push([=]() { createEnemy(renderer, enemy, summoned); });
+}
+
 Entity createBullet(vec2 pos, float angle, float speed, bool can_richochet, float max_dist, bool shot_by_player, bool piercing, float damage, float scale, GUN_ID id)
 {
 	auto entity = Entity();
@@ -677,7 +499,7 @@ Entity createBullet(vec2 pos, float angle, float speed, bool can_richochet, floa
 	CollisionMesh collision_mesh = createCapsuleCollisionMesh(entity, 0.5, 5, AXIS::X);//createEllipseCollisionMesh(entity, 8);
 	collision_mesh.is_solid = true;
 	collision_mesh.is_static = false;
-	registry.collisionMeshes.insert(entity, collision_mesh);
+	registry.collisionMeshes.insert(entity, std::move(collision_mesh));
 
 	Projectile& proj = registry.projectiles.emplace(entity);
 	proj.can_richochet = can_richochet;
@@ -733,6 +555,24 @@ Entity createBullet(vec2 pos, float angle, float speed, bool can_richochet, floa
 	return entity;
 
 }
+void fireBullet(vec2 pos, float angle, float speed, bool can_richochet, float max_dist, bool shot_by_player, bool piercing, float damage, float scale, GUN_ID id)
+{
+	// Exploding shots hit enemies too and bouncing or piercing ones need their collisions resolved, those stay entities
+	if (shot_by_player || can_richochet || piercing || id == GUN_ID::EXPLOSION_SHOT) {
+		createBullet(pos, angle, speed, can_richochet, max_dist, shot_by_player, piercing, damage, scale, id);
+		return;
+	}
+
+	BULLET_STYLE style = BULLET_STYLE::ICE_SHARD;
+	if (id == GUN_ID::OMNI_SHOT)
+		style = BULLET_STYLE::ENERGY_BLAST;
+	else if (id == GUN_ID::ZAP_SHOT)
+		style = BULLET_STYLE::BOLT;
+	else if (id == GUN_ID::FIRE_SHOT)
+		style = BULLET_STYLE::FIRE;
+	bulletSystem.spawn(pos, angle, speed, max_dist, damage, style);
+}
+
 Entity createParticleSystem(vec2 position, vec2 velocity, int num, float lifetime, float angle, int size, TEXTURE_ASSET_ID tex) {
 	Entity entity = Entity();
 
@@ -764,17 +604,13 @@ Entity createParticleSystem(vec2 position, vec2 velocity, int num, float lifetim
 
 void createItem(RenderSystem* renderer, vec2 pos, ITEM_ID item_id, GUN_ID gun_id, bool shattered) {
 	auto entity = Entity();
+	const ItemPrefab& prefab = prefabTable.item();
 
 	// Store a reference to the potentially re-used mesh object (the value is stored in the resource cache)
-	Mesh& mesh = renderer->getMesh(GEOMETRY_BUFFER_ID::ANIMATED_SPRITE);
-	registry.meshPtrs.emplace(entity, &mesh);
+	registry.meshPtrs.emplace(entity, prefab.mesh);
 
-	auto& motion = registry.motions.emplace(entity);
-	motion.angle = M_PI;
-	motion.velocity = { 0.f, 0.f };
+	Motion& motion = registry.motions.insert(entity, prefab.motion);
 	motion.position = pos;
-	motion.scale = mesh.original_size * 150.f;
-	motion.scale.x *= -1;
 
 	auto& item = registry.items.emplace(entity);
 	item.item_id = item_id;
@@ -782,10 +618,7 @@ void createItem(RenderSystem* renderer, vec2 pos, ITEM_ID item_id, GUN_ID gun_id
 	item.position = pos;
 	item.shattered = shattered;
 
-	auto& animation = registry.animations.emplace(entity);
-	animation.frame = 0;
-	animation.num_frames = 4;
-	animation.speed = 300.f;
+	Animation& animation = registry.animations.insert(entity, prefab.animation);
 
 	// Initialize animation and item parameters depending on ID
 	if (item_id == ITEM_ID::HEALTH) {
@@ -850,20 +683,11 @@ void createItem(RenderSystem* renderer, vec2 pos, ITEM_ID item_id, GUN_ID gun_id
 		animation.num_frames = 1;
 	}
 
-	// Create a collision mesh for the entity
-	CollisionMesh collision_mesh = createEllipseCollisionMesh(entity, 3);
 	if (item_id != ITEM_ID::NO_ITEM) {
-		collision_mesh.is_solid = true;
-		collision_mesh.is_static = true;
-		registry.collisionMeshes.insert(entity, collision_mesh);
+		registry.collisionMeshes.insert(entity, prefab.collision_mesh);
 	}
 
-	registry.renderRequests.insert(
-		entity,
-		{ TEXTURE_ASSET_ID::SPRITESHEET,
-		 EFFECT_ASSET_ID::ANIMATED,
-		 GEOMETRY_BUFFER_ID::ANIMATED_SPRITE },
-		(unsigned int)RENDER_LAYER_ID::MIDGROUND_FAR);
+	registry.renderRequests.insert(entity, prefab.render_request, (unsigned int)RENDER_LAYER_ID::MIDGROUND_FAR);
 }
 
 void swapGun(Entity player, int hotbar_index) {
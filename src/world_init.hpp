@@ -3,7 +3,10 @@
 #include "common.hpp"
 #include "tiny_ecs.hpp"
 #include "render_system.hpp"
-#include <random>
+#include "rng.hpp"
+
+// stlib
+#include <vector>
 
 // These are hard coded to the dimensions of the entity texture
 const float ENEMY_BB_WIDTH = 0.4f * 300.f;
@@ -14,10 +17,47 @@ Gun createGun(GUN_ID gun_id);
 // the player
 Entity createPlayer(RenderSystem* renderer, vec2 pos);
 
+// An enemy with every random decision about it made, planning only draws from the stream it is given and doesn't touch the registry
+struct PlannedEnemy {
+	ENEMY_ID id = ENEMY_ID::NORMAL;
+	vec2 position = { 0.f, 0.f };
+	vec2 velocity = { 0.f, 0.f };
+	// Index of the swarm in the room, the swarm's enemies share a flock, -1 for enemies without one
+	int swarm = -1;
+	// Bombers of a swarm don't flock
+	bool in_flock = false;
+	float angle = 0.f;
+	// Spin of a zapper
+	bool rotate_direction = false;
+	float gun_timer_ms = 0.f;
+};
+
 Entity createEnemy(RenderSystem* renderer, vec2 position, vec2 velocity, ENEMY_ID id, bool summoned);
+Entity createEnemy(RenderSystem* renderer, const PlannedEnemy& enemy, bool summoned);
 
 Entity createBoss(RenderSystem* renderer, vec2 position, vec2 velocity, int coins);
 
+// Adds the boid to the flock, it is removed again automatically when it is destroyed
+void addToFlock(Entity flock, Entity boid);
+
+// Random position in the spawn rectangle and a small random start velocity
+void randomSpawn(RandomStream& random, vec2 spawnMin, vec2 spawnMax, vec2& position, vec2& velocity);
+
+// A flock chasing the target with room for count boids
+Entity createFlock(Entity target, int count);
+
+// Spawns the planned enemies of a room through the spawn queue, with a flock for every swarm
+void spawnPlannedEnemies(RenderSystem* renderer, Entity target, const std::vector<PlannedEnemy>& enemies);
+
+// The plan functions add the enemies of one swarm to enemies, the create functions plan from the spawn stream and spawn the swarm
+void planEasySwarm(RandomStream& random, vec2 spawnMin, vec2 spawnMax, int count, int swarm, std::vector<PlannedEnemy>& enemies);
+void planSwarm(RandomStream& random, vec2 spawnMin, vec2 spawnMax, int count, int maxElite, int swarm, std::vector<PlannedEnemy>& enemies);
+void planMegaSwarm(RandomStream& random, vec2 spawnMin, vec2 spawnMax, int coins, int roomsCleared, int swarm, std::vector<PlannedEnemy>& enemies);
+void planFlameThrowerSwarm(RandomStream& random, vec2 spawnMin, vec2 spawnMax, int count, int swarm, std::vector<PlannedEnemy>& enemies);
+void planZapperSwarm(RandomStream& random, vec2 spawnMin, vec2 spawnMax, int count, int swarm, std::vector<PlannedEnemy>& enemies);
+// Bombers don't flock
+void planBombers(RandomStream& random, vec2 spawnMin, vec2 spawnMax, int count, std::vector<PlannedEnemy>& enemies);
+
 Entity createEasySwarm(RenderSystem* renderer, Entity target, vec2 spawnMin, vec2 spawnMax, int count, bool summoned);
 
 Entity createSwarm(RenderSystem* renderer, Entity target, vec2 spawnMin, vec2 spawnMax, int count, int maxElite, bool summoned);
@@ -33,11 +73,13 @@ void createBombers(RenderSystem* renderer, Entity target, vec2 spawnMin, vec2 sp
 
 Entity createBullet(vec2 pos, float angle, float speed, bool can_richochet, float max_dist, bool shot_by_player, bool piercing, float damage, float scale, GUN_ID id);
 
+// Fires a bullet from a gun, the player's bullets become entities while enemy and boss bullets go to the bullet system
+void fireBullet(vec2 pos, float angle, float speed, bool can_richochet, float max_dist, bool shot_by_player, bool piercing, float damage, float scale, GUN_ID id);
+
 Entity createMovingWall(RenderSystem* renderer, vec2 start_pos, vec2 end_pos, float period_ms, float width, float height);
 
 Entity createParticleSystem(vec2 position, vec2 velocity, int num, float lifetime, float angle, int size, TEXTURE_ASSET_ID tex);
 
-vec2 catmullrom(vec2 p0, vec2 p1, vec2 p2, vec2 p3, float t);
 
 Entity createSplineBullet(vec2 start_pos, vec2 end_pos, float angle, float speed, bool can_richochet, float max_dist, bool shot_by_player, bool shot_by_boss, float damage);
 
@@ -6,10 +6,20 @@
 // stlib
 #include <cassert>
 #include <sstream>
-#include <random>
 #include <algorithm>
 
 #include "physics_system.hpp"
+#include "particles.hpp"
+#include "profiler.hpp"
+#include "telemetry.hpp"
+#include "scenario.hpp"
+#include "rng.hpp"
+#include "projectile_pool.hpp"
+#include "bullet_system.hpp"
+#include "gun_table.hpp"
+#include "spline_arena.hpp"
+#include "prefabs.hpp"
+#include "spawn_queue.hpp"
 #include <room_generation.hpp>
 
 // GLFW Image Loader
@@ -24,7 +34,12 @@
 
 // Game configuration
 const size_t BOSS_DELAY_MS = 9000 * 3;
-const float INITIAL_DODGE_PARTICLE_POSITION = -100;
+// Bullets the components and the projectile pool are sized for up front
+const size_t PROJECTILE_POOL_SIZE = 512;
+// Enemy and boss bullets the bullet system is sized for up front
+const size_t ENEMY_BULLET_CAPACITY = 4096;
+// Spline bullet paths the spline arena is sized for up front
+const size_t SPLINE_CURVE_CAPACITY = 256;
 SoundSystem soundSystem;
 
 bool tutorial_ongoing = true;
@@ -34,20 +49,24 @@ bool shop_room = false;
 WorldSystem::WorldSystem()
 	: next_turtle_spawn(0.f)
 	, next_fish_spawn(0.f) {
-	// Seeding rng with random device
-	rng = std::default_random_engine(std::random_device()());
 }
 
 WorldSystem::~WorldSystem() {
+#ifndef HEADLESS
 	// Destroy music components
 	Mix_CloseAudio();
+#endif
 
 	// Destroy all created components
 	registry.clear_all_components();
+#ifndef HEADLESS
 	// Close the window
 	glfwDestroyWindow(window);
+#endif
 }
 
+// The headless build has no window or audio device, see src/headless/
+#ifndef HEADLESS
 // Debugging
 namespace {
 	void glfw_err_cb(int error, const char *desc) {
@@ -198,11 +217,18 @@ GLFWwindow* WorldSystem::create_window() {
 	ControllerSystem::set_sound_system(soundSystem);
 	return window;
 }
+#endif
 
 void WorldSystem::init(RenderSystem* renderer_arg, UISystem* ui_system) {
 	this->renderer = renderer_arg;
 	this->ui_system = ui_system;
 	ControllerSystem::set_ui_system(ui_system);
+	init_collision_handlers();
+	// Spawning copies the prefabs, they are built once the meshes and guns are loaded
+	prefabTable.init(renderer);
+	projectilePool.reserve(PROJECTILE_POOL_SIZE);
+	bulletSystem.reserve(ENEMY_BULLET_CAPACITY);
+	splineArena.reserve(SPLINE_CURVE_CAPACITY);
 	// Set all states to default
 	start_game();
 	soundSystem.playBGM();
@@ -210,6 +236,7 @@ void WorldSystem::init(RenderSystem* renderer_arg, UISystem* ui_system) {
 
 // Update our game world
 bool WorldSystem::step(float elapsed_ms_since_last_update) {
+	PROFILE_SCOPE("WorldSystem::step");
 	// Remove debug info from the last step
 	while (registry.debugComponents.entities.size() > 0)
 	    registry.remove_all_components_of(registry.debugComponents.entities.back());
@@ -277,6 +304,12 @@ bool WorldSystem::step(float elapsed_ms_since_last_update) {
 		soundSystem.stopFire();
 	}
 
+	// The room entered in the transition is built a few spawns at a time
+	spawnQueue.step();
+	// Coins picked up or a room cleared change what is behind the doors
+	if (registry.players.has(player))
+		room_planner.update(roomInputs(player));
+
 	ScreenState& screen = registry.screenStates.components[0];
 	float min_timer_ms = 2400.f;
 	//for (Entity entity : registry.transitionTimers.entities) {
@@ -294,6 +327,8 @@ bool WorldSystem::step(float elapsed_ms_since_last_update) {
 		}
 
 		if (timer.timer_ms < 0) {
+			// Whatever the budget didn't get to yet is there when the fight starts
+			spawnQueue.finish();
 			for (auto& entity : registry.walls.entities)
 			{
 				if (registry.renderRequests.has(entity)) {
@@ -328,6 +363,7 @@ bool WorldSystem::step(float elapsed_ms_since_last_update) {
 
 		if (timer.timer_ms < 300 && !timer.entering){
 			soundSystem.playSteps();
+			spawnQueue.begin_staging();
 			enter_room(timer.from, timer.type);
 			
 			createRubble(renderer, (timer.from + 2) % 4);
@@ -412,7 +448,7 @@ bool WorldSystem::step(float elapsed_ms_since_last_update) {
 					animation.row = 2;
 				}
 
-				if (rand() % 100 > 60 && registry.enemies.components.size() == 0) {
+				if (randomService.stream(RNG_STREAM::WORLD).range(0, 99) > 60 && registry.enemies.components.size() == 0) {
 					createMegaSwarm(renderer, player, vec2(500, 500), vec2(700, 700), 3, 3, true);
 					registry.guns.get(entity).is_firing = false;
 					registry.summonTimers.emplace(entity);
@@ -427,7 +463,7 @@ bool WorldSystem::step(float elapsed_ms_since_last_update) {
 				}
 			}
 			// Reset timer
-			boss.cooldown = (BOSS_DELAY_MS / 2) + uniform_dist(rng) * (BOSS_DELAY_MS / 2);
+			boss.cooldown = (BOSS_DELAY_MS / 2) + randomService.stream(RNG_STREAM::WORLD).uniform() * (BOSS_DELAY_MS / 2);
 		}
 	}
 
@@ -440,133 +476,10 @@ bool WorldSystem::step(float elapsed_ms_since_last_update) {
 		bool shot_by_player = registry.players.has(entity);
 		bool shot_by_boss = registry.bosses.has(entity);
 		gun.timer_ms = std::max(gun.timer_ms - elapsed_ms_since_last_update, 0.f);
-		float speed = 0;
-		float dist = 0;
-		float damage = 0;
 		if (gun.is_firing && gun.timer_ms <= 0) {
 			Motion motion = registry.motions.get(entity);
-			vec2 offset = { 0,0 };
-			if (shot_by_player) {
-				offset = {80 * cos(motion.angle), 80 * sin(motion.angle)};
-			}
-			if (gun.gun_id == GUN_ID::STRAIGHT_SHOT) {
-				if (shot_by_player) {
-					speed = 600;
-					dist = registry.players.get(player).range;
-					damage = 10;
-					createBullet(motion.position + offset, motion.angle, speed, false, dist, shot_by_player, false, damage, 1, gun.gun_id);
-				}
-				else {
-					speed = 400;
-					dist = 800;
-					damage = 2;
-					createBullet(motion.position + offset, motion.angle, speed, false, dist, shot_by_player, false, damage, 1, gun.gun_id);
-				}
-			}
-			else if (gun.gun_id == GUN_ID::SPLIT_SHOT) {
-				float deg_to_rad = M_PI / 180.0;
-				speed = 500;
-				dist = registry.players.get(player).range;
-				damage = 5;
-				createBullet(motion.position + offset, motion.angle - 15 * deg_to_rad, speed, false, dist, shot_by_player, false, damage, 1, gun.gun_id);
-				createBullet(motion.position + offset, motion.angle, speed, false, dist, shot_by_player, false, damage, 1, gun.gun_id);
-				createBullet(motion.position + offset, motion.angle + 15 * deg_to_rad, speed, false, dist, shot_by_player, false, damage, 1, gun.gun_id);
-			}
-			else if (gun.gun_id == GUN_ID::BOUNCING_SHOT) {
-				speed = 600;
-				dist = registry.players.get(player).range;
-				damage = 8;
-				createBullet(motion.position + offset, motion.angle, speed, true, dist, shot_by_player, false, damage, 1, gun.gun_id);
-			}
-			else if (gun.gun_id == GUN_ID::SPLINE_SHOT) {
-				speed = 600;
-				dist = 600;
-				damage = 10;
-				createSplineBullet(motion.position + offset, registry.motions.get(player).position, motion.angle, speed, true, dist, shot_by_player, shot_by_boss, damage);
-			}
-			else if (gun.gun_id == GUN_ID::SPLIT_SPLINE_SHOT) {
-				float deg_to_rad = M_PI / 180.0;
-				speed = 800;
-				dist = 800;
-				damage = 5;
-				createSplineBullet(motion.position, registry.motions.get(player).position, motion.angle - 30 * deg_to_rad, speed, false, dist, shot_by_player, shot_by_boss, damage);
-				createSplineBullet(motion.position, registry.motions.get(player).position, motion.angle - 15 * deg_to_rad, speed, false, dist, shot_by_player, shot_by_boss, damage);
-				createSplineBullet(motion.position, registry.motions.get(player).position, motion.angle, speed, false, dist, shot_by_player, shot_by_boss, damage);
-				createSplineBullet(motion.position, registry.motions.get(player).position, motion.angle + 15 * deg_to_rad, speed, false, dist, shot_by_player, shot_by_boss, damage);
-				createSplineBullet(motion.position, registry.motions.get(player).position, motion.angle + 30 * deg_to_rad, speed, false, dist, shot_by_player, shot_by_boss, damage);
-			}
-			else if (gun.gun_id == GUN_ID::RAPID_SHOT) {
-				std::random_device rd;
-				std::mt19937 gen(rd());
-				std::uniform_real_distribution<float> angle_distribution(-7.5, 7.5);
-				float angle_offset = angle_distribution(gen);
-				float deg_to_rad = M_PI / 180.0;
-				speed = 600;
-				dist = registry.players.get(player).range;
-				damage = 4;
-				createBullet(motion.position + offset, motion.angle + angle_offset * deg_to_rad, speed, false, dist, shot_by_player, false, damage, 1, gun.gun_id);
-			}
-			else if (gun.gun_id == GUN_ID::LONG_SHOT) {
-				speed = 2000;
-				dist =registry.players.get(player).range;
-				damage = 25;
-				createBullet(motion.position + offset, motion.angle, speed, false, dist + 500, shot_by_player, true, damage, 2, gun.gun_id);
-			}
-			else if (gun.gun_id == GUN_ID::OMNI_SHOT) {
-				float deg_to_rad = M_PI / 180.0;
-				float other_angle = motion.angle + M_PI;
-				float side_angle1 = motion.angle + M_PI / 2;
-				float side_angle2 = motion.angle - M_PI / 2;
-
-				speed = 500;
-				dist = 1000;
-				damage = 7;
-				createBullet(motion.position, motion.angle - 30 * deg_to_rad, speed, false, dist, shot_by_player, false, damage, 1, gun.gun_id);
-				createBullet(motion.position, motion.angle - 15 * deg_to_rad, speed, false, dist, shot_by_player, false, damage, 1, gun.gun_id);
-				createBullet(motion.position, motion.angle, speed, false, dist, shot_by_player, false, damage, 1, gun.gun_id);
-				createBullet(motion.position, motion.angle + 15 * deg_to_rad, speed, false, dist, shot_by_player, false, damage, 1, gun.gun_id);
-				createBullet(motion.position, motion.angle + 30 * deg_to_rad, speed, false, dist, shot_by_player, false, damage, 1, gun.gun_id);
-
-				createBullet(motion.position, other_angle - 30 * deg_to_rad, speed, false, dist, shot_by_player, false, damage, 1, gun.gun_id);
-				createBullet(motion.position, other_angle - 15 * deg_to_rad, speed, false, dist, shot_by_player, false, damage, 1, gun.gun_id);
-				createBullet(motion.position, other_angle, speed, false, dist, shot_by_player, false, damage, 1, gun.gun_id);
-				createBullet(motion.position, other_angle + 15 * deg_to_rad, speed, false, dist, shot_by_player, false, damage, 1, gun.gun_id);
-				createBullet(motion.position, other_angle + 30 * deg_to_rad, speed, false, dist, shot_by_player, false, damage, 1, gun.gun_id);
-
-				createBullet(motion.position, side_angle1 - 30 * deg_to_rad, speed, false, dist, shot_by_player, false, damage, 1, gun.gun_id);
-				createBullet(motion.position, side_angle1 - 15 * deg_to_rad, speed, false, dist, shot_by_player, false, damage, 1, gun.gun_id);
-				createBullet(motion.position, side_angle1, speed, false, dist, shot_by_player, false, damage, 1, gun.gun_id);
-				createBullet(motion.position, side_angle1 + 15 * deg_to_rad, speed, false, dist, shot_by_player, false, damage, 1, gun.gun_id);
-				createBullet(motion.position, side_angle1 + 30 * deg_to_rad, speed, false, dist, shot_by_player, false, damage, 1, gun.gun_id);
-
-				createBullet(motion.position, side_angle2 - 30 * deg_to_rad, speed, false, dist, shot_by_player, false, damage, 1, gun.gun_id);
-				createBullet(motion.position, side_angle2 - 15 * deg_to_rad, speed, false, dist, shot_by_player, false, damage, 1, gun.gun_id);
-				createBullet(motion.position, side_angle2, speed, false, dist, shot_by_player, false, damage, 1, gun.gun_id);
-				createBullet(motion.position, side_angle2 + 15 * deg_to_rad, speed, false, dist, shot_by_player, false, damage, 1, gun.gun_id);
-				createBullet(motion.position, side_angle2 + 30 * deg_to_rad, speed, false, dist, shot_by_player, false, damage, 1, gun.gun_id);
-			}
-			else if (gun.gun_id == GUN_ID::ZAP_SHOT) {
-				float deg_to_rad = M_PI / 180.0;
-				float other_angle = motion.angle + M_PI;
-				speed = 700;
-				dist = 800;
-				damage = 10;
-				createBullet(motion.position, motion.angle - 45 * deg_to_rad, speed, false, dist, shot_by_player, false, damage, 1, gun.gun_id);
-				createBullet(motion.position, motion.angle + 45 * deg_to_rad, speed, false, dist, shot_by_player, false, damage, 1, gun.gun_id);
-				createBullet(motion.position, other_angle - 45 * deg_to_rad, speed, false, dist, shot_by_player, false, damage, 1, gun.gun_id);
-				createBullet(motion.position, other_angle + 45 * deg_to_rad, speed, false, dist, shot_by_player, false, damage, 1, gun.gun_id);
-			}
-			else if (gun.gun_id == GUN_ID::FIRE_SHOT) {
-				std::random_device rd;
-				std::mt19937 gen(rd());
-				std::uniform_real_distribution<float> angle_distribution(-7.5, 7.5);
-				float angle_offset = angle_distribution(gen);
-				float deg_to_rad = M_PI / 180.0;
-				speed = 500;
-				dist = 400;
-				damage = 2;
-				createBullet(motion.position + offset, motion.angle + angle_offset * deg_to_rad, speed, false, dist, shot_by_player, false, damage, 1, gun.gun_id);
-			}
+			gunTable.fire(gun.gun_id, motion.position, motion.angle, shot_by_player, shot_by_boss,
+				registry.motions.get(player).position, registry.players.get(player).range);
 
 			if (shot_by_player) {
 				soundSystem.playPlayerShoot();
@@ -631,7 +544,7 @@ bool WorldSystem::step(float elapsed_ms_since_last_update) {
 			registry.flocks.emplace(flock);
 			auto& flockComponent = registry.flocks.get(flock);
 			flockComponent.target = player;
-			flockComponent.boids.push_back(entity);
+			addToFlock(flock, entity);
 			createSwarm(renderer, player, vec2(500, 500), vec2(700, 700), 3, 1, true);
 			registry.introTimers.remove(entity);
 		}
@@ -734,231 +647,11 @@ bool WorldSystem::step(float elapsed_ms_since_last_update) {
 		}
 	}
 
-	// There are removals within the loop so we need the iterator
-	for (Entity particle : registry.particleSystems.entities) {
-		ParticleSystem& particleSystem = registry.particleSystems.get(particle);
-
-		if (particleSystem.lifetime < 0) {
-			if (particleSystem.texture == TEXTURE_ASSET_ID::PRIZE && particleSystem.has_spawned) {
-				ui_system->exit_state(UI_STATE_ID::PLAYING);
-				ui_system->enter_state(UI_STATE_ID::SCORE);
-			}
-			particleSystem.has_spawned = false;
-			registry.remove_all_components_of(particle);
-		} else {
-			if (particleSystem.texture == TEXTURE_ASSET_ID::SMOKE && registry.dodgeTimers.has(player)) {
-				vec2 relativePosition = registry.dodgeTimers.get(player).initialPosition - registry.dodgeTimers.get(player).finalPosition;
-				vec2 playerMovement = registry.dodgeTimers.get(player).initialPosition - registry.motions.get(player).position;
-				particleSystem.angle = (atan2(relativePosition.x, relativePosition.y)) * 180.0f / M_PI;
-				int foundIndex = -1;
-				for (int i = 0; i < particleSystem.num_particles - 1; i++) {
-					if (particleSystem.particles[i].lifetime <= 0) {
-						particleSystem.particles[i].position.x = INITIAL_DODGE_PARTICLE_POSITION;
-						particleSystem.particles[i].position.y = INITIAL_DODGE_PARTICLE_POSITION;
-					}
-					else if (particleSystem.particles[i].position.x == INITIAL_DODGE_PARTICLE_POSITION && particleSystem.particles[i].position.y == INITIAL_DODGE_PARTICLE_POSITION) {
-						foundIndex = i;
-						particleSystem.particles[i].lifetime = 200.f;
-						break;
-					}
-					else {
-						particleSystem.particles[i].lifetime -= elapsed_ms_since_last_update;
-					}
-				}
-
-
-				if (foundIndex != -1 && playerMovement != vec2(0, 0) && particleSystem.particles[foundIndex].lifetime >= 0) {
-					float incX = relativePosition.x / particleSystem.num_particles;
-					float incY = relativePosition.y / particleSystem.num_particles;
-
-					if (abs(incX * foundIndex) <= abs(playerMovement.x) && abs(incY * foundIndex) <= abs(playerMovement.y)) {
-						particleSystem.particles[foundIndex].position.x = registry.motions.get(player).position.x;
-						particleSystem.particles[foundIndex].position.y = registry.motions.get(player).position.y;
-					}
-				}
-
-				particleSystem.has_spawned = true;
-
-			}
-			// partially used gpt
-			if (particleSystem.texture == TEXTURE_ASSET_ID::DEATH || particleSystem.texture == TEXTURE_ASSET_ID::DEATH_GREEN || particleSystem.texture == TEXTURE_ASSET_ID::DEATH_BLUE || particleSystem.texture == TEXTURE_ASSET_ID::DEATH_BOSS || particleSystem.texture == TEXTURE_ASSET_ID::DEATH_MINE || particleSystem.texture == TEXTURE_ASSET_ID::DEATH_GARBAGE || particleSystem.texture == TEXTURE_ASSET_ID::DEATH_BOMB) {
-				if (!particleSystem.has_spawned) {
-					for (int i = 0; i < particleSystem.num_particles; i++) {
-						particleSystem.particles[i].position.y -= i * 10.f;
-						particleSystem.particles[i].velocity.x = 0.0f;
-						particleSystem.particles[i].velocity.y = -100.0f;
-						particleSystem.particles[i].angle = i * 50.0f;
-					}
-					particleSystem.has_spawned = true;
-				}
-
-				for (int i = 0; i < particleSystem.num_particles; i++) {
-					particleSystem.particles[i].angle += elapsed_ms_since_last_update * 0.4f;
-					float wave = sin(particleSystem.particles[i].angle * (M_PI / 180.0f)) * 80.0f;
-					particleSystem.particles[i].velocity.x = wave;
-
-					particleSystem.particles[i].position += particleSystem.particles[i].velocity * (elapsed_ms_since_last_update / 1000.0f);
-				}
-			}
-
-			if(particleSystem.texture == TEXTURE_ASSET_ID::HEART_PARTICLE)  {
-				if (!particleSystem.has_spawned) {
-					for (int i = 0; i < particleSystem.num_particles; i++) {
-						float angleVariation = (float)rand() / (float)RAND_MAX * M_PI / 4 - M_PI / 8;
-						float angle = M_PI / 2 + angleVariation; 
-						float speed = 2.f * (float)rand() / (float)RAND_MAX * 100 + 500;
-						vec2 velocity = {5* speed * cos(angle) * 0.1f, speed * sin(angle)};
-						particleSystem.particles[i].velocity = velocity;
-					};
-					particleSystem.has_spawned = true;
-				}
-				for (size_t i = 0; i < particleSystem.num_particles; i++) {
-					particleSystem.particles[i].velocity.y += 980.0f * elapsed_ms_since_last_update / 2000.0f; 
-					particleSystem.particles[i].velocity.x *= 0.99f;  // Apply drag
-					particleSystem.particles[i].position += particleSystem.particles[i].velocity * elapsed_ms_since_last_update / 1000.0f;
-
-					// Simple bounce on ground collision, assuming ground is at y = 0
-					vec2 initial_position = particleSystem.init_position;
-					if (particleSystem.particles[i].position.y >= initial_position.y) {
-						particleSystem.particles[i].position.y = initial_position.y;
-						particleSystem.particles[i].velocity.y = -particleSystem.particles[i].velocity.y * 0.7;
-					}
-
-				}
-
-			}
-
-			if(particleSystem.texture == TEXTURE_ASSET_ID::COIN)  {
-				vec2 player_position = registry.motions.get(player).position;
-				if (!particleSystem.has_spawned) {
-					for (int i = 0; i < particleSystem.num_particles; i++) {
-						float random_offset_x = rand() % 50 + 1;
-						float random_offset_y = rand() % 50 + 1;
-
-						particleSystem.particles[i].position += vec2(random_offset_x, random_offset_y);
-						vec2 direction_to_player = normalize(player_position - particleSystem.particles[i].position);
-						float speed = 500.0f;
-						particleSystem.particles[i].velocity = direction_to_player * speed;
-					}
-					particleSystem.has_spawned = true;
-				}
-
-				for (size_t i = 0; i < particleSystem.num_particles; i++) {
-					if (particleSystem.particles[i].lifetime > 0) {
-						vec2 direction_to_player = normalize(player_position - particleSystem.particles[i].position);
-						float distance_to_player = length(player_position - particleSystem.particles[i].position);
-
-						float attraction_strength = 10000.0f;
-						float max_velocity = 500.0f;
-						attraction_strength *= (1.0f - distance_to_player / 10000.0f);
-						particleSystem.particles[i].velocity += direction_to_player * attraction_strength * elapsed_ms_since_last_update / 1000.0f;
-
-						if (length(particleSystem.particles[i].velocity) > max_velocity) {
-							particleSystem.particles[i].velocity = normalize(particleSystem.particles[i].velocity) * max_velocity;
-						}
-
-						particleSystem.particles[i].velocity *= 0.99f;
-
-						particleSystem.particles[i].position += particleSystem.particles[i].velocity * elapsed_ms_since_last_update / 1000.0f;
-						if (distance_to_player < 50.0f) {
-							Player& player = registry.players.components[0];
-							player.coins += 5;
-							particleSystem.particles[i].lifetime = 0.0f;
-						}
-					}
-					else {
-						particleSystem.particles[i].position.x = INITIAL_DODGE_PARTICLE_POSITION;
-						particleSystem.particles[i].position.y = INITIAL_DODGE_PARTICLE_POSITION;
-					}
-				}
-			}
-
-			if (particleSystem.texture == TEXTURE_ASSET_ID::PRIZE) {
-				if (!particleSystem.has_spawned) {
-					for (int i = 0; i < particleSystem.num_particles; i++) {
-						vec2 initial_position = (i % 2 == 0) ? vec2(0, window_height_px) : vec2(window_width_px, window_height_px);
-
-						float angleVariation = (float)rand() / (float)RAND_MAX * M_PI / 8 - M_PI / 16;
-						float angle = ((i % 2 == 0) ? -M_PI / 3 : -5 * M_PI / 7) + angleVariation;
-						float speed = 1000 + (float)rand() / (float)RAND_MAX * 500;
-						vec2 velocity = { speed * cos(angle), speed * sin(angle) };
-
-						particleSystem.particles[i].position = initial_position;
-						particleSystem.particles[i].velocity = velocity;
-					};
-					particleSystem.has_spawned = true;
-				}
-				for (size_t i = 0; i < particleSystem.num_particles; i++) {
-					particleSystem.particles[i].velocity.y += 980.0f * elapsed_ms_since_last_update / 1000.0f;
-					particleSystem.particles[i].position += particleSystem.particles[i].velocity * elapsed_ms_since_last_update / 1000.0f;
-					if (particleSystem.lifetime < 2000) {
-						screen.screen_darken_factor += elapsed_ms_since_last_update / 300000.0f;
-					}
-				}
-			}
-			
-			if (particleSystem.texture == TEXTURE_ASSET_ID::SPARK_BASE) {
-				if (!particleSystem.has_spawned) {
-					vec2 particlePosition = particleSystem.position;
-					vec2 velocity = particleSystem.velocity;
-					// ChatGPT velocity randomization
-					float originalAngle = glm::atan(velocity.y, velocity.x);
-					particleSystem.angle = glm::degrees(originalAngle);
-
-					for (int i = 0; i < particleSystem.num_particles; i++) {
-						// Generate a random angle between +30 and -30 degrees in radians
-						float randomAngle = rand() % 600; // start at 600 to capture some decimal places
-						randomAngle = (randomAngle - 300.0f) / 10.0f; // Divide as a float afterwards
-
-						// Add the random angle to the original angle
-						float finalAngle = originalAngle + glm::radians(randomAngle);
-						particleSystem.particles[i].velocity = vec2(glm::cos(finalAngle), glm::sin(finalAngle)) * 400.0f;
-						particleSystem.particles[i].angle = finalAngle;
-					}
-					particleSystem.has_spawned = true;
-				}
-
-				for (size_t i = 0; i < particleSystem.num_particles; i++) {
-					particleSystem.particles[i].velocity.x *= 0.99f;
-					particleSystem.particles[i].velocity.y *= 0.99f;
-					particleSystem.particles[i].position += particleSystem.particles[i].velocity * (elapsed_ms_since_last_update / 1000.0f);
-				}
-			}
-			if (particleSystem.texture == TEXTURE_ASSET_ID::BULLET_DEAD_BASE ||
-				particleSystem.texture == TEXTURE_ASSET_ID::ENEMY_BULLET_DEAD ||
-				particleSystem.texture == TEXTURE_ASSET_ID::SPLINE_BULLET_DEAD ||
-				particleSystem.texture == TEXTURE_ASSET_ID::BULLET_DEAD_ZAPPER)
-			{
-				// This is the same behaviour as sparks but it's creation conditions are different. Leaving both
-				if (!particleSystem.has_spawned) {
-					vec2 particlePosition = particleSystem.position;
-					vec2 velocity = particleSystem.velocity;
-					// ChatGPT velocity randomization
-					float originalAngle = glm::atan(velocity.y, velocity.x);
-					particleSystem.angle = glm::degrees(originalAngle);
-					for (int i = 0; i < particleSystem.num_particles; i++) {
-						// Generate a random angle between +30 and -30 degrees in radians
-						float randomAngle = rand() % 300; // start at 600 to capture some decimal places
-						randomAngle = (randomAngle - 150.0f) / 10.0f; // Divide as a float afterwards
-
-						// Add the random angle to the original angle
-						float finalAngle = originalAngle + glm::radians(randomAngle);
-						particleSystem.particles[i].velocity = vec2(glm::cos(finalAngle), glm::sin(finalAngle)) * glm::length(velocity);
-						particleSystem.particles[i].angle = finalAngle;
-					}
-					particleSystem.has_spawned = true;
-				}
-
-				for (size_t i = 0; i < particleSystem.num_particles; i++) {
-					particleSystem.particles[i].velocity.x *= 0.99f;
-					particleSystem.particles[i].velocity.y *= 0.99f;
-					particleSystem.particles[i].position += particleSystem.particles[i].velocity * (elapsed_ms_since_last_update / 1000.0f);
-				}
-			}
-			particleSystem.lifetime -= elapsed_ms_since_last_update;
-		}
-
-	};
+	if (stepParticleSystems(elapsed_ms_since_last_update, player, screen)) {
+		// The prize shower has finished
+		ui_system->exit_state(UI_STATE_ID::PLAYING);
+		ui_system->enter_state(UI_STATE_ID::SCORE);
+	}
 	return true;
 }
 
@@ -973,7 +666,7 @@ void WorldSystem::check_ui() {
 		}
 		else {
 			Alert alert = {"No save file found!"};
-			registry.alerts.insert(Entity(), alert);
+			registry.alerts.insert(Entity(ENTITY_SCOPE::UI), alert);
 		}
 		
 	}
@@ -981,16 +674,16 @@ void WorldSystem::check_ui() {
 		// save game
 		if (tutorial_ongoing) {
 			Alert alert = { "You cannot save in the tutorial!" };
-			registry.alerts.insert(Entity(), alert);
+			registry.alerts.insert(Entity(ENTITY_SCOPE::UI), alert);
 		} else if (!shop_room || registry.transitionTimers.size() > 0) {
 			// cant save game
 			Alert alert = { "You can only save in a Shop Room!" };
-			registry.alerts.insert(Entity(), alert);
+			registry.alerts.insert(Entity(ENTITY_SCOPE::UI), alert);
 		}
 		else {
 			save_game();
 			Alert alert = { "Game saved successfully!" };
-			registry.alerts.insert(Entity(), alert);
+			registry.alerts.insert(Entity(ENTITY_SCOPE::UI), alert);
 		}
 	}
 	else if (ui_system->pressed_button == UI_BUTTON_ID::NEW_GAME) {
@@ -1010,6 +703,7 @@ void WorldSystem::check_ui() {
 void WorldSystem::start_game() {
 	tutorial_ongoing = true;
 	shop_room = false;
+	telemetry.set_room_type(ROOM_TYPE::TUTORIAL);
 	// Debugging for memory/component leaks
 	registry.list_all_components();
 	printf("Restarting\n");
@@ -1017,14 +711,11 @@ void WorldSystem::start_game() {
 	// Reset the game speed
 	current_speed = 1.f;
 
-	// Remove all entities that we created
-	// All that have a motion, we could also iterate over all fish, turtles, ... but that would be more cumbersome
-	while (registry.motions.entities.size() > 0)
-	    registry.remove_all_components_of(registry.motions.entities.back());
-	registry.dialogues.clear();
-	registry.alerts.clear();
-	registry.messages.clear();
-	registry.deathTimers.clear();
+	// Remove all entities that we created, the room and the UI a scope at a time and the old player on its own
+	registry.clear_scope(ENTITY_SCOPE::ROOM);
+	registry.clear_scope(ENTITY_SCOPE::UI);
+	registry.remove_all_components_of(player);
+	spawnQueue.clear();
 	// Debugging for memory/component leaks
 	registry.list_all_components();
 	ScreenState& screen = registry.screenStates.components[0];
@@ -1038,11 +729,9 @@ void WorldSystem::start_game() {
 	soundSystem.playBGM();
 	// Create floor
 	createTutorialRoomOne(renderer,player);
+	room_planner.plan_doors(randomService.stream(RNG_STREAM::ROOMS), roomInputs(player));
 
-	for (Entity particle : registry.particleSystems.entities) {
-		ParticleSystem& particleSystem = registry.particleSystems.get(particle);
-		registry.remove_all_components_of(particle);
-	}
+	bulletSystem.clear();
 }
 
 void WorldSystem::restart_game() {
@@ -1055,14 +744,11 @@ void WorldSystem::restart_game() {
 	// Reset the game speed
 	current_speed = 1.f;
 
-	// Remove all entities that we created
-	// All that have a motion, we could also iterate over all fish, turtles, ... but that would be more cumbersome
-	while (registry.motions.entities.size() > 0)
-		registry.remove_all_components_of(registry.motions.entities.back());
-	registry.dialogues.clear();
-	registry.alerts.clear();
-	registry.messages.clear();
-	registry.deathTimers.clear();
+	// Remove all entities that we created, the room and the UI a scope at a time and the old player on its own
+	registry.clear_scope(ENTITY_SCOPE::ROOM);
+	registry.clear_scope(ENTITY_SCOPE::UI);
+	registry.remove_all_components_of(player);
+	spawnQueue.clear();
 	// Debugging for memory/component leaks
 	registry.list_all_components();
 	
@@ -1074,6 +760,7 @@ void WorldSystem::restart_game() {
 
 	// Create floor
 	createTutorialRoomFour(renderer, player);
+	room_planner.plan_doors(randomService.stream(RNG_STREAM::ROOMS), roomInputs(player));
 	
 	for (auto& entity : registry.doors.entities)
 		{
@@ -1092,13 +779,11 @@ void WorldSystem::restart_game() {
 
 	}
 
-	for (Entity particle : registry.particleSystems.entities) {
-		ParticleSystem& particleSystem = registry.particleSystems.get(particle);
-		registry.remove_all_components_of(particle);
-	}
+	bulletSystem.clear();
 }
 
 void WorldSystem::enter_room(int from, int type) {
+	PROFILE_SCOPE("WorldSystem::enter_room");
 	// Debugging for memory/component leaks
 	registry.players.get(player).last_door = from;
 	registry.list_all_components();
@@ -1106,18 +791,9 @@ void WorldSystem::enter_room(int from, int type) {
 	// Reset the game speed
 	current_speed = 1.f;
 
-	for (auto& entity : registry.motions.entities)
-	{
-		if (registry.players.has(entity) || registry.transitionTimers.has(entity))
-			continue;
-		else {
-			registry.remove_all_components_of(entity);
-		}
-	}
-	for (Entity particle : registry.particleSystems.entities) {
-		ParticleSystem& particleSystem = registry.particleSystems.get(particle);
-		registry.remove_all_components_of(particle);
-	}
+	// Everything of the old room goes at once, the player and the UI are in scopes of their own
+	registry.clear_scope(ENTITY_SCOPE::ROOM);
+	bulletSystem.clear();
 
 	// Debugging for memory/component leaks
 	registry.list_all_components();
@@ -1150,44 +826,81 @@ void WorldSystem::enter_room(int from, int type) {
 		registry.dodgeTimers.get(player).finalPosition = end;
 	}
 	
+	// Rooms planned ahead only need to be built
+	RoomDescriptor planned_room;
+	bool planned = room_planner.take(from, type, roomInputs(player), planned_room);
+
 	switch (type) {
 	case 0:
 		soundSystem.playBGM();
-		createEnemyRoom(renderer, player, from);
+		if (planned)
+			buildRoom(renderer, player, planned_room);
+		else
+			createEnemyRoom(renderer, player, from);
 		tutorial_ongoing = false;
 		shop_room = false;
+		telemetry.set_room_type(ROOM_TYPE::ENEMY);
 		break;
 	case 1:
 		soundSystem.playShopBGM();
-		createShopRoom(renderer, player, from);
+		if (planned)
+			buildRoom(renderer, player, planned_room);
+		else
+			createShopRoom(renderer, player, from);
 		tutorial_ongoing = false;
 		shop_room = true;
+		telemetry.set_room_type(ROOM_TYPE::SHOP);
 		break;
 	case 2:
 		createTutorialRoomTwo(renderer, player);
 		tutorial_ongoing = true;
 		shop_room = false;
+		telemetry.set_room_type(ROOM_TYPE::TUTORIAL);
 		break;
 	case 3:
 		createTutorialRoomThree(renderer,player);
 		tutorial_ongoing = true;
 		shop_room = false;
+		telemetry.set_room_type(ROOM_TYPE::TUTORIAL);
 		break;
 	case 4:
 		createTutorialRoomFour(renderer, player);
 		tutorial_ongoing = true;
 		shop_room = false;
+		telemetry.set_room_type(ROOM_TYPE::TUTORIAL);
 		break;
 	case 5:
 		soundSystem.playBossBGM();
-		createBossRoom(renderer, player, from);
+		if (planned)
+			buildRoom(renderer, player, planned_room);
+		else
+			createBossRoom(renderer, player, from);
 		tutorial_ongoing = false;
 		shop_room = false;
+		telemetry.set_room_type(ROOM_TYPE::BOSS);
 		break;
 	}
+	room_planner.plan_doors(randomService.stream(RNG_STREAM::ROOMS), roomInputs(player));
 }
 
 
+bool WorldSystem::load_scenario(const std::string& path) {
+	registry.dialogues.clear();
+	current_speed = 1.f;
+
+	// Everything but the player and the UI goes
+	registry.clear_scope(ENTITY_SCOPE::ROOM);
+	bulletSystem.clear();
+	spawnQueue.clear();
+	room_planner.clear();
+
+	tutorial_ongoing = false;
+	shop_room = false;
+	// Scenarios are combat rooms
+	telemetry.set_room_type(ROOM_TYPE::ENEMY);
+	return loadScenario(path, renderer, player);
+}
+
 
 // Helper function to get the motion scale of an entity
 vec2 getScale(const Entity entity) {
@@ -1202,530 +915,546 @@ vec2 getPosition(const Entity entity) {
 	return registry.motions.get(entity).position;
 }
 
+// Index into the collision handler table
+// Contacts where either mesh is not solid are looked up in a separate half of the table
+static int collision_handler_key(bool is_solid, COLLISION_CATEGORY category, COLLISION_CATEGORY other_category) {
+	return ((is_solid ? 1 : 0) * collision_category_count + (int)category) * collision_category_count + (int)other_category;
+}
+
+void WorldSystem::register_collision_handler(bool is_solid, COLLISION_CATEGORY category, COLLISION_CATEGORY other_category, CollisionHandler handler) {
+	assert(category <= other_category && "Collision handlers are registered with the lower category first");
+	collision_handlers[collision_handler_key(is_solid, category, other_category)] = handler;
+}
+
+void WorldSystem::init_collision_handlers() {
+	collision_handlers.fill(nullptr);
+
+	// Solid contacts
+	register_collision_handler(true, COLLISION_CATEGORY::PROJECTILE, COLLISION_CATEGORY::PLAYER, &WorldSystem::handle_projectile_player);
+	register_collision_handler(true, COLLISION_CATEGORY::PROJECTILE, COLLISION_CATEGORY::ENEMY, &WorldSystem::handle_projectile_enemy);
+	register_collision_handler(true, COLLISION_CATEGORY::PROJECTILE, COLLISION_CATEGORY::BOSS, &WorldSystem::handle_projectile_boss);
+	register_collision_handler(true, COLLISION_CATEGORY::PROJECTILE, COLLISION_CATEGORY::WALL, &WorldSystem::handle_projectile_wall);
+	register_collision_handler(true, COLLISION_CATEGORY::PROJECTILE, COLLISION_CATEGORY::DOOR, &WorldSystem::handle_projectile_obstacle);
+	register_collision_handler(true, COLLISION_CATEGORY::PROJECTILE, COLLISION_CATEGORY::ITEM, &WorldSystem::handle_projectile_item);
+	register_collision_handler(true, COLLISION_CATEGORY::PROJECTILE, COLLISION_CATEGORY::OTHER, &WorldSystem::handle_projectile_obstacle);
+	register_collision_handler(true, COLLISION_CATEGORY::PLAYER, COLLISION_CATEGORY::ENEMY, &WorldSystem::handle_player_enemy);
+	register_collision_handler(true, COLLISION_CATEGORY::PLAYER, COLLISION_CATEGORY::BOSS, &WorldSystem::handle_player_obstacle);
+	register_collision_handler(true, COLLISION_CATEGORY::PLAYER, COLLISION_CATEGORY::WALL, &WorldSystem::handle_player_obstacle);
+	register_collision_handler(true, COLLISION_CATEGORY::PLAYER, COLLISION_CATEGORY::DOOR, &WorldSystem::handle_player_obstacle);
+	register_collision_handler(true, COLLISION_CATEGORY::PLAYER, COLLISION_CATEGORY::ITEM, &WorldSystem::handle_player_item);
+	register_collision_handler(true, COLLISION_CATEGORY::PLAYER, COLLISION_CATEGORY::OTHER, &WorldSystem::handle_player_obstacle);
+
+	// Non-solid contacts
+	register_collision_handler(false, COLLISION_CATEGORY::PLAYER, COLLISION_CATEGORY::DOOR, &WorldSystem::handle_player_door);
+}
+
 // Compute collisions between entities
 void WorldSystem::handle_collisions() {
-	// Loop over all collisions detected by the physics system
+	PROFILE_SCOPE("WorldSystem::handle_collisions");
+	// Gather all collisions detected by the physics system, ordered by category
 	auto& collisionsRegistry = registry.collisions;
+	collision_events.clear();
 	for (uint i = 0; i < collisionsRegistry.components.size(); i++) {
-
 		Collision collision = collisionsRegistry.components[i];
 		Entity entity1 = collisionsRegistry.entities[i];
 		Entity entity2 = collision.other_entity;
 
+		if (collision.category > collision.other_category) {
+			std::swap(entity1, entity2);
+			std::swap(collision.category, collision.other_category);
+			collision.other_entity = entity2;
+			collision.overlap_normal = -collision.overlap_normal;
+		}
+
+		if (!registry.collisionMeshes.has(entity1) || !registry.collisionMeshes.has(entity2)) continue;
+		bool is_solid = registry.collisionMeshes.get(entity1).is_solid && registry.collisionMeshes.get(entity2).is_solid;
+		int key = collision_handler_key(is_solid, collision.category, collision.other_category);
+		if (collision_handlers[key] == nullptr) continue;
+
+		collision_events.push_back({ key, entity1, entity2, collision });
+	}
+
+	// Handle collisions of the same type together, keeping detection order within a type
+	std::stable_sort(collision_events.begin(), collision_events.end(), [](const CollisionEvent& a, const CollisionEvent& b) {
+		return a.key < b.key;
+	});
+
+	for (CollisionEvent& event : collision_events) {
 		// It is entirely possible that one of the entities has already been removed by a previous collision
-		if (!registry.collisionMeshes.has(entity2) || !registry.collisionMeshes.has(entity1)) continue;
+		if (!registry.collisionMeshes.has(event.entity) || !registry.collisionMeshes.has(event.other_entity)) continue;
 
-		CollisionMesh& mesh1 = registry.collisionMeshes.get(entity1);
-		CollisionMesh& mesh2 = registry.collisionMeshes.get(entity2);
+		(this->*collision_handlers[event.key])(event.entity, event.other_entity, event.collision);
+	}
 
-		// Handle collisions with solid surfaces
-		if (mesh1.is_solid && mesh2.is_solid) {
-			
-			// Check projectile collisions
-			if (registry.projectiles.has(entity1) || registry.projectiles.has(entity2)) {
-				Entity projectile_entity = registry.projectiles.has(entity1) ? entity1 : entity2;
-				Entity other_entity = registry.projectiles.has(entity1) ? entity2 : entity1;
-				Projectile& projectile = registry.projectiles.get(projectile_entity);
-				bool destroy_projectile = true;
-				// Ricochet projectiles off of walls
-				if (projectile.can_richochet && registry.walls.has(other_entity)) {
-					// handle ricochet
-					Motion& motion = registry.motions.get(projectile_entity);
-
-					vec2 d = motion.velocity;
-					vec2 n = collision.overlap_normal;					
-					motion.velocity = d - 2 * dot(d, n) * n;
-					motion.angle = atan(motion.velocity.y / motion.velocity.x);
-					Entity particles = createParticleSystem(motion.position, collision.overlap_normal, 7, 150.0f, 0.f, 16, TEXTURE_ASSET_ID::SPARK_BASE);
-					ParticleSystem& particleSys = registry.particleSystems.get(particles);
-					particleSys.texture_glow = TEXTURE_ASSET_ID::SPARK_GLOW;
-					destroy_projectile = false;
-				} else {
-					// Handle projectile damage
-					if (registry.enemies.has(other_entity)) {
-						Enemy& enemy = registry.enemies.get(other_entity);
-						enemy.health -= projectile.damage;
-						soundSystem.playEnemyDamage();
-
-						if (registry.animations.has(other_entity)) {
-							Animation& animation = registry.animations.get(other_entity);
-							if (enemy.id == ENEMY_ID::NORMAL) {
-								animation.row = 5;
-							}
-							else if (enemy.id == ENEMY_ID::ELITE) {
-								animation.row = 16;
-							}
-							else if (enemy.id == ENEMY_ID::DUMMY) {
-								animation.row = 20;
-							}
-							else if (enemy.id == ENEMY_ID::ZAPPER) {
-								animation.row = 35;
-							}
-							else if (enemy.id == ENEMY_ID::FLAMETHROWER) {
-								animation.row = 37;
-							}
-							else if (enemy.id == ENEMY_ID::BOMBER) {
-								animation.row = 33;
-							}
-						}
-
-                        
-						if (registry.damageTimers.has(other_entity))
-						{
-							DamageTimer& timer = registry.damageTimers.get(other_entity);
-							timer.timer_ms = 100.f;
-						}
-						else
-						{
-							registry.damageTimers.emplace(other_entity);
-						}
-						
-						if (projectile.piercing) {
-							destroy_projectile = false;
-							projectile.hit_entities.push_back(other_entity);
-						}
-
-						if (projectile.can_richochet) {
-							destroy_projectile = false;
-							projectile.hit_entities.push_back(other_entity);
-							projectile.can_richochet = false;
-							Motion& motion = registry.motions.get(projectile_entity);
-
-							vec2 d = motion.velocity;
-							vec2 n = collision.overlap_normal;
-							motion.velocity = d - 2 * dot(d, n) * n;
-							motion.angle = atan(motion.velocity.y / motion.velocity.x);
-						}
-
-						if (enemy.health <= 0) {
-							// Remove enemy
-							// Drop Coins
-							soundSystem.playEnemyDeath();
-							createParticleSystem(registry.motions.get(projectile_entity).position, { 0, 0 }, enemy.coin_drop / 5, 5000.f, 0.f, 32, TEXTURE_ASSET_ID::COIN);
-							if (enemy.id == ENEMY_ID::NORMAL) {
-								createParticleSystem(registry.motions.get(other_entity).position, { 0, 0 }, 1, 3000.f, 0.f, 52, TEXTURE_ASSET_ID::DEATH_BLUE);
-							} else if (enemy.id == ENEMY_ID::ELITE) {
-								createParticleSystem(registry.motions.get(other_entity).position, { 0, 0 }, 1, 3000.f, 0.f, 74, TEXTURE_ASSET_ID::DEATH_GREEN);
-							} else if (enemy.id == ENEMY_ID::DUMMY) {
-								createParticleSystem(registry.motions.get(other_entity).position, { 0, 0 }, 1, 3000.f, 0.f, 52, TEXTURE_ASSET_ID::DEATH);
-							} else if (enemy.id == ENEMY_ID::BOMBER) {
-								Motion motion = registry.motions.get(other_entity);
-								explode(motion.position, motion.angle);
-							} else if (enemy.id == ENEMY_ID::ZAPPER) {
-								createParticleSystem(registry.motions.get(other_entity).position, { 0, 0 }, 1, 3000.f, 0.f, 62, TEXTURE_ASSET_ID::DEATH_MINE);
-							} else if (enemy.id == ENEMY_ID::FLAMETHROWER) {
-								createParticleSystem(registry.motions.get(other_entity).position, { 0, 0 }, 1, 3000.f, 0.f, 62, TEXTURE_ASSET_ID::DEATH_GARBAGE);
-							}
-
-
-							// Add to coin count after clearing a room
-							Player& player = registry.players.components[0];
-							registry.remove_all_components_of(other_entity);
-							if (registry.enemies.components.size() == 0) {
-								player.roomsCleared += 1;
-								
-								for (auto& entity : registry.doors.entities)
-								{
-									soundSystem.playOpenDoor();
-									openDoor(entity);
-								}
-							}
-						}
+	// Enemy and boss bullets that hit the player, a dead player has lost its collision mesh and takes no more hits
+	for (float damage : bulletSystem.player_hits) {
+		if (registry.collisionMeshes.has(player))
+			damage_player(player, damage);
+	}
+	bulletSystem.player_hits.clear();
 
+	// Remove all collisions from this simulation step
+	registry.collisions.clear();
+	return;
+}
 
-					}
-					else if (registry.bosses.has(other_entity) && !registry.introTimers.has(other_entity)) {
-						Boss& boss = registry.bosses.get(other_entity);
-						boss.health -= projectile.damage;
-
-						if (boss.health < 0) {
-							boss.health = 0;
-						}
-
-						soundSystem.playBossDamage();
-						if (registry.animations.has(other_entity)) {
-							Animation& animation = registry.animations.get(other_entity);
-
-							if (boss.id == BOSS_ID::IDLE) {
-								animation.row = 1;
-							}
-							else {
-								animation.row = 3;
-							}
-							
-						}
-
-						if (projectile.can_richochet) {
-							destroy_projectile = false;
-							projectile.hit_entities.push_back(other_entity);
-							projectile.can_richochet = false;
-							Motion& motion = registry.motions.get(projectile_entity);
-
-							vec2 d = motion.velocity;
-							vec2 n = collision.overlap_normal;
-							motion.velocity = d - 2 * dot(d, n) * n;
-							motion.angle = atan(motion.velocity.y / motion.velocity.x);
-						}
-
-
-						if (registry.damageTimers.has(other_entity))
-						{
-							DamageTimer& timer = registry.damageTimers.get(other_entity);
-							timer.timer_ms = 100.f;
-						}
-						else
-						{
-							registry.damageTimers.emplace(other_entity);
-						}
-						if (projectile.piercing) {
-							destroy_projectile = false;
-							projectile.hit_entities.push_back(other_entity);
-						}
-
-						if (boss.health <= 0) {
-							// Remove enemy
-							// Drop Coins
-							createParticleSystem(registry.motions.get(other_entity).position, { 0, 0 }, boss.coin_drop / 5, 5000.f, 0.f, 32, TEXTURE_ASSET_ID::COIN);
-							createParticleSystem(registry.motions.get(other_entity).position, { 0, 0 }, 1, 3000.f, 0.f, 100, TEXTURE_ASSET_ID::DEATH_BOSS);
-							Entity message = Entity();
-							registry.messages.insert(message,
-								{
-									"BOSS DEFEATED!",
-									vec2(window_width_px / 2, window_height_px / 2),
-									FONT_SIZE_ID::EXTRA_LARGE });
-							createParticleSystem({ -100, -100 }, { 0, 0 }, 300, 5000.f, 0.f, 32, TEXTURE_ASSET_ID::PRIZE);
-							registry.notEnoughCoinsTimer.emplace(message);
-							NotEnoughCoinsTimer& timer = registry.notEnoughCoinsTimer.components[0];
-							timer.timer_ms = 5000.f;
-							// Add to coin count after clearing a room
-							registry.victories.emplace(player);
-							registry.remove_all_components_of(other_entity);
-							for (Entity entity: registry.enemies.entities ) {
-								registry.remove_all_components_of(entity);
-							}
-							soundSystem.playBossDeath();
-						}
-					}
-					else if (registry.players.has(other_entity)) {
-						Player& player = registry.players.get(other_entity);
-
-						if (!registry.victories.has(other_entity)) {
-							player.health -= projectile.damage;
-
-							if (player.health < 0) {
-								player.health = 0;
-							}
-
-							if (!registry.damageTimers.has(other_entity) ){
-								vec3& color = registry.colors.get(other_entity);
-								color = { 1, 0, 0 };
-								registry.damageTimers.emplace(other_entity);
-							}
-							soundSystem.playPlayerDamage();
-						}
-						if (projectile.piercing) {
-							destroy_projectile = false;
-							projectile.hit_entities.push_back(other_entity);
-						}
-
-						if (player.health <= 0 && registry.deathTimers.size() == 0) {
-							// Handle player death
-
-
-							createParticleSystem(registry.motions.get(other_entity).position, { 0, 0 }, player.coins/ 5, 5000.f, 0.f, 32, TEXTURE_ASSET_ID::HEART_PARTICLE);
-							createParticleSystem(registry.motions.get(other_entity).position, { 0, 0 }, 1, 5000.f, 0.f, 64, TEXTURE_ASSET_ID::DEATH);
-
-							registry.guns.clear();
-							registry.collisionMeshes.remove(other_entity);
-							registry.renderRequests.remove(other_entity);
-							Hotbar& hotbar = registry.hotbars.get(other_entity);
-							for (int i = 0; i < hotbar.capacity; i++) {
-								hotbar.guns[i] = GUN_ID::NO_GUN;
-							}
-							Entity deathMessage = Entity();
-							registry.deathTimers.emplace(deathMessage);
-							soundSystem.playPlayerDeath();
-							registry.messages.insert(deathMessage,
-								{ "You Died!",
-								vec2(window_width_px / 2, window_height_px / 2),
-								FONT_SIZE_ID::EXTRA_LARGE});
-						}
-						
-					}
-					else if (registry.itemContainers.has(other_entity)) {
-						// Shatter glass container if have enough money
-						float cost = registry.itemContainers.get(other_entity).cost;
-						Player& player = registry.players.components[0];
-						if ((player.coins - cost) >= 0) {
-							soundSystem.playGlassBreak();
-							player.coins -= cost;
-							Animation& animation = registry.animations.get(other_entity);
-							animation.frame = 0;
-							if (registry.healthItems.has(other_entity)) {
-								animation.row = 8;
-							}
-							else if (registry.gunItems.has(other_entity)) {
-								if (registry.gunItems.get(other_entity).id == GUN_ID::BOUNCING_SHOT) {
-									animation.row = 24;
-								}
-								else if (registry.gunItems.get(other_entity).id == GUN_ID::SPLIT_SHOT) {
-									animation.row = 10;
-								}
-								else if (registry.gunItems.get(other_entity).id == GUN_ID::LONG_SHOT) {
-									animation.row = 28;
-								}
-								else if (registry.gunItems.get(other_entity).id == GUN_ID::RAPID_SHOT) {
-									animation.row = 30;
-								}
-							}
-							else if (registry.rangeItems.has(other_entity)) {
-								animation.row = 26;
-							}
-							registry.itemContainers.remove(other_entity);
-							registry.items.get(other_entity).shattered = true;
-						}
-						else {
-							// Produce "Not Enough Coins!" message if not enough money
-							if (registry.notEnoughCoinsTimer.components.size() >= 1)
-							{
-								NotEnoughCoinsTimer& timer = registry.notEnoughCoinsTimer.components[0];
-								timer.timer_ms = 1000.f;
-							}
-							else
-							{
-								Entity message = Entity();
-								registry.notEnoughCoinsTimer.emplace(message);
-								registry.messages.insert(message,
-									{ 
-										"Not Enough Coins!",
-										vec2(window_width_px / 2, window_height_px / 2),
-										FONT_SIZE_ID::EXTRA_LARGE});
-								soundSystem.playError();
-							}
-						}
-					}
-				}
+// Reflects the projectile's velocity about the collision normal
+static void ricochet(Entity projectile_entity, const Collision& collision) {
+	Motion& motion = registry.motions.get(projectile_entity);
 
-				if (destroy_projectile) {
-					registry.remove_all_components_of(projectile_entity);
-				}
-			}
+	vec2 d = motion.velocity;
+	vec2 n = collision.overlap_normal;
+	motion.velocity = d - 2 * dot(d, n) * n;
+	motion.angle = atan(motion.velocity.y / motion.velocity.x);
 
-			// Check player collisions
-			if (registry.players.has(entity1)) {
-				if (registry.enemies.has(entity2) && registry.enemies.get(entity2).id == ENEMY_ID::BOMBER){
-					if (!registry.summonTimers.has(entity2))
-					{
-						explode(registry.motions.get(entity2).position, registry.motions.get(entity2).angle);
-						registry.remove_all_components_of(entity2);
-						if (registry.enemies.components.size() == 0) {
-							registry.players.get(player).roomsCleared += 1;
-							for (auto& entity : registry.doors.entities)
-							{
-								soundSystem.playOpenDoor();
-								openDoor(entity);
-							}
-						}
-					}
-				}
-				else if (registry.healthItems.has(entity2) && !registry.itemContainers.has(entity2)) {
-					Animation& animation = registry.animations.get(entity2);
-					animation.frame = 0;
-					animation.row = 6;
-					animation.num_frames = 1;
+	// Spline bullets leave their curve and carry on in a straight line from here
+	if (registry.splineBullets.has(projectile_entity)) {
+		SplineBullet& spline = registry.splineBullets.get(projectile_entity);
+		spline.distance_covered = max(spline.distance_covered, spline.total_distance);
+		spline.last_point_crossed = true;
+	}
+}
 
-					Player& player = registry.players.get(entity1);
-					player.health += registry.healthItems.get(entity2).restore;
+// Opens the doors of the room once the last enemy has been removed
+static void check_room_cleared() {
+	if (registry.enemies.components.size() == 0) {
+		Player& player = registry.players.components[0];
+		player.roomsCleared += 1;
 
-					if (player.health > player.max_health) {
-						player.health = player.max_health;
-					}
-					soundSystem.playHeal();
-					registry.healthItems.remove(entity2);
-					registry.collisionMeshes.remove(entity2);
-					registry.items.get(entity2).item_id = ITEM_ID::NO_ITEM;
-				}
+		for (auto& entity : registry.doors.entities)
+		{
+			soundSystem.playOpenDoor();
+			openDoor(entity);
+		}
+	}
+}
 
-				if (registry.gunItems.has(entity2) && !registry.itemContainers.has(entity2)) {
-					Animation& animation = registry.animations.get(entity2);
-					animation.frame = 0;
-					animation.row = 6;
-					animation.num_frames = 1;
+void WorldSystem::handle_projectile_player(Entity projectile_entity, Entity other_entity, const Collision&) {
+	Projectile& projectile = registry.projectiles.get(projectile_entity);
+	bool destroy_projectile = true;
+	damage_player(other_entity, projectile.damage);
 
-					if (registry.gunItems.get(entity2).id == GUN_ID::BOUNCING_SHOT) {
-						registry.hasBounces.emplace(entity1);
-					}
-					else if (registry.gunItems.get(entity2).id == GUN_ID::SPLIT_SHOT) {
-						registry.hasSplits.emplace(entity1);
-					}
-					else if (registry.gunItems.get(entity2).id == GUN_ID::LONG_SHOT) {
-						registry.hasLongs.emplace(entity1);
-					}
-					else if (registry.gunItems.get(entity2).id == GUN_ID::RAPID_SHOT) {
-						registry.hasRapids.emplace(entity1);
-					}
+	if (projectile.piercing) {
+		destroy_projectile = false;
+		projectile.hit_entities.push_back(other_entity);
+	}
 
-					Hotbar& hotbar = registry.hotbars.get(entity1);
-					for (int i = 0; i < hotbar.capacity; i++) {
-						if (hotbar.guns[i] == GUN_ID::NO_GUN) {
-							hotbar.guns[i] = registry.gunItems.get(entity2).id;
-							break;
-						}
-					}
-					soundSystem.playPowerUp();
+	if (destroy_projectile) {
+		registry.remove_all_components_of(projectile_entity);
+	}
+}
 
-					registry.gunItems.remove(entity2);
-					registry.collisionMeshes.remove(entity2);
-					registry.items.get(entity2).item_id = ITEM_ID::NO_ITEM;
-				}
+void WorldSystem::damage_player(Entity player_entity, float damage) {
+	Player& player = registry.players.get(player_entity);
 
-				if (registry.rangeItems.has(entity2) && !registry.itemContainers.has(entity2)) {
-					Animation& animation = registry.animations.get(entity2);
-					animation.frame = 0;
-					animation.row = 6;
-					animation.num_frames = 1;
+	if (!registry.victories.has(player_entity)) {
+		player.health -= damage;
 
-					Player& player = registry.players.get(entity1);
-					player.range += registry.rangeItems.get(entity2).increase;
+		if (player.health < 0) {
+			player.health = 0;
+		}
 
-					if (player.range > player.max_range) {
-						player.range = player.range;
-					}
-					soundSystem.playPowerUp();
-					registry.rangeItems.remove(entity2);
-					registry.collisionMeshes.remove(entity2);
-					registry.items.get(entity2).item_id = ITEM_ID::NO_ITEM;
-				}
+		if (!registry.damageTimers.has(player_entity) ){
+			vec3& color = registry.colors.get(player_entity);
+			color = { 1, 0, 0 };
+			registry.damageTimers.emplace(player_entity);
+		}
+		soundSystem.playPlayerDamage();
+	}
 
-				//handle_player_collisions(entity1, entity2);
-				if (registry.dodgeTimers.has(entity1)) {
-					registry.dodgeTimers.remove(entity1);
-				}
+	if (player.health <= 0 && registry.deathTimers.size() == 0) {
+		// Handle player death
+		createParticleSystem(registry.motions.get(player_entity).position, { 0, 0 }, player.coins/ 5, 5000.f, 0.f, 32, TEXTURE_ASSET_ID::HEART_PARTICLE);
+		createParticleSystem(registry.motions.get(player_entity).position, { 0, 0 }, 1, 5000.f, 0.f, 64, TEXTURE_ASSET_ID::DEATH);
+
+		registry.guns.clear();
+		registry.collisionMeshes.remove(player_entity);
+		registry.renderRequests.remove(player_entity);
+		Hotbar& hotbar = registry.hotbars.get(player_entity);
+		for (int i = 0; i < hotbar.capacity; i++) {
+			hotbar.guns[i] = GUN_ID::NO_GUN;
+		}
+		Entity deathMessage = Entity(ENTITY_SCOPE::UI);
+		registry.deathTimers.emplace(deathMessage);
+		soundSystem.playPlayerDeath();
+		registry.messages.insert(deathMessage,
+			{ "You Died!",
+			vec2(window_width_px / 2, window_height_px / 2),
+			FONT_SIZE_ID::EXTRA_LARGE});
+	}
+
+	if (registry.dodgeTimers.has(player_entity)) {
+		registry.dodgeTimers.remove(player_entity);
+	}
+}
+
+void WorldSystem::handle_projectile_enemy(Entity projectile_entity, Entity other_entity, const Collision& collision) {
+	Projectile& projectile = registry.projectiles.get(projectile_entity);
+	bool destroy_projectile = true;
+	Enemy& enemy = registry.enemies.get(other_entity);
+	enemy.health -= projectile.damage;
+	soundSystem.playEnemyDamage();
+
+	if (registry.animations.has(other_entity)) {
+		Animation& animation = registry.animations.get(other_entity);
+		if (enemy.id == ENEMY_ID::NORMAL) {
+			animation.row = 5;
+		}
+		else if (enemy.id == ENEMY_ID::ELITE) {
+			animation.row = 16;
+		}
+		else if (enemy.id == ENEMY_ID::DUMMY) {
+			animation.row = 20;
+		}
+		else if (enemy.id == ENEMY_ID::ZAPPER) {
+			animation.row = 35;
+		}
+		else if (enemy.id == ENEMY_ID::FLAMETHROWER) {
+			animation.row = 37;
+		}
+		else if (enemy.id == ENEMY_ID::BOMBER) {
+			animation.row = 33;
+		}
+	}
+
+	if (registry.damageTimers.has(other_entity))
+	{
+		DamageTimer& timer = registry.damageTimers.get(other_entity);
+		timer.timer_ms = 100.f;
+	}
+	else
+	{
+		registry.damageTimers.emplace(other_entity);
+	}
+
+	if (projectile.piercing) {
+		destroy_projectile = false;
+		projectile.hit_entities.push_back(other_entity);
+	}
+
+	if (projectile.can_richochet) {
+		destroy_projectile = false;
+		projectile.hit_entities.push_back(other_entity);
+		projectile.can_richochet = false;
+		ricochet(projectile_entity, collision);
+	}
+
+	if (enemy.health <= 0) {
+		// Remove enemy
+		// Drop Coins
+		soundSystem.playEnemyDeath();
+		createParticleSystem(registry.motions.get(projectile_entity).position, { 0, 0 }, enemy.coin_drop / 5, 5000.f, 0.f, 32, TEXTURE_ASSET_ID::COIN);
+		if (enemy.id == ENEMY_ID::NORMAL) {
+			createParticleSystem(registry.motions.get(other_entity).position, { 0, 0 }, 1, 3000.f, 0.f, 52, TEXTURE_ASSET_ID::DEATH_BLUE);
+		} else if (enemy.id == ENEMY_ID::ELITE) {
+			createParticleSystem(registry.motions.get(other_entity).position, { 0, 0 }, 1, 3000.f, 0.f, 74, TEXTURE_ASSET_ID::DEATH_GREEN);
+		} else if (enemy.id == ENEMY_ID::DUMMY) {
+			createParticleSystem(registry.motions.get(other_entity).position, { 0, 0 }, 1, 3000.f, 0.f, 52, TEXTURE_ASSET_ID::DEATH);
+		} else if (enemy.id == ENEMY_ID::BOMBER) {
+			Motion motion = registry.motions.get(other_entity);
+			explode(motion.position, motion.angle);
+		} else if (enemy.id == ENEMY_ID::ZAPPER) {
+			createParticleSystem(registry.motions.get(other_entity).position, { 0, 0 }, 1, 3000.f, 0.f, 62, TEXTURE_ASSET_ID::DEATH_MINE);
+		} else if (enemy.id == ENEMY_ID::FLAMETHROWER) {
+			createParticleSystem(registry.motions.get(other_entity).position, { 0, 0 }, 1, 3000.f, 0.f, 62, TEXTURE_ASSET_ID::DEATH_GARBAGE);
+		}
+
+		// Add to coin count after clearing a room
+		registry.remove_all_components_of(other_entity);
+		check_room_cleared();
+	}
+
+	if (destroy_projectile) {
+		registry.remove_all_components_of(projectile_entity);
+	}
+}
+
+void WorldSystem::handle_projectile_boss(Entity projectile_entity, Entity other_entity, const Collision& collision) {
+	Projectile& projectile = registry.projectiles.get(projectile_entity);
+	bool destroy_projectile = true;
+
+	// Bosses can not be damaged during their introduction
+	if (!registry.introTimers.has(other_entity)) {
+		Boss& boss = registry.bosses.get(other_entity);
+		boss.health -= projectile.damage;
+
+		if (boss.health < 0) {
+			boss.health = 0;
+		}
+
+		soundSystem.playBossDamage();
+		if (registry.animations.has(other_entity)) {
+			Animation& animation = registry.animations.get(other_entity);
+
+			if (boss.id == BOSS_ID::IDLE) {
+				animation.row = 1;
 			}
-			else if (registry.players.has(entity2)) {
-				if (registry.healthItems.has(entity1) && !registry.itemContainers.has(entity1)) {
-					Animation& animation = registry.animations.get(entity1);
-					animation.frame = 0;
-					animation.row = 6;
-					animation.num_frames = 1;
-
-					Player& player = registry.players.get(entity2);
-					player.health += registry.healthItems.get(entity1).restore;
-
-					if (player.health > player.max_health) {
-						player.health = player.max_health;
-					}
-					soundSystem.playHeal();
-					registry.healthItems.remove(entity1);
-					registry.collisionMeshes.remove(entity1);
-					registry.items.get(entity1).item_id = ITEM_ID::NO_ITEM;
-				}
+			else {
+				animation.row = 3;
+			}
+		}
 
-				if (registry.gunItems.has(entity1) && !registry.itemContainers.has(entity1)) {
-					Animation& animation = registry.animations.get(entity1);
-					animation.frame = 0;
-					animation.row = 6;
-					animation.num_frames = 1;
+		if (projectile.can_richochet) {
+			destroy_projectile = false;
+			projectile.hit_entities.push_back(other_entity);
+			projectile.can_richochet = false;
+			ricochet(projectile_entity, collision);
+		}
 
-					if (registry.guns.has(entity2)) {
-						registry.guns.remove(entity2);
-					}
+		if (registry.damageTimers.has(other_entity))
+		{
+			DamageTimer& timer = registry.damageTimers.get(other_entity);
+			timer.timer_ms = 100.f;
+		}
+		else
+		{
+			registry.damageTimers.emplace(other_entity);
+		}
+		if (projectile.piercing) {
+			destroy_projectile = false;
+			projectile.hit_entities.push_back(other_entity);
+		}
 
-					if (registry.gunItems.get(entity1).id == GUN_ID::BOUNCING_SHOT) {
-						registry.hasBounces.emplace(entity2);
-					}
-					else if (registry.gunItems.get(entity1).id == GUN_ID::SPLIT_SHOT) {
-						registry.hasSplits.emplace(entity2);
-					}
-					else if (registry.gunItems.get(entity1).id == GUN_ID::LONG_SHOT) {
-						registry.hasLongs.emplace(entity2);
-					}
-					else if (registry.gunItems.get(entity1).id == GUN_ID::RAPID_SHOT) {
-						registry.hasRapids.emplace(entity2);
-					}
+		if (boss.health <= 0) {
+			// Remove enemy
+			// Drop Coins
+			createParticleSystem(registry.motions.get(other_entity).position, { 0, 0 }, boss.coin_drop / 5, 5000.f, 0.f, 32, TEXTURE_ASSET_ID::COIN);
+			createParticleSystem(registry.motions.get(other_entity).position, { 0, 0 }, 1, 3000.f, 0.f, 100, TEXTURE_ASSET_ID::DEATH_BOSS);
+			Entity message = Entity(ENTITY_SCOPE::UI);
+			registry.messages.insert(message,
+				{
+					"BOSS DEFEATED!",
+					vec2(window_width_px / 2, window_height_px / 2),
+					FONT_SIZE_ID::EXTRA_LARGE });
+			createParticleSystem({ -100, -100 }, { 0, 0 }, 300, 5000.f, 0.f, 32, TEXTURE_ASSET_ID::PRIZE);
+			registry.notEnoughCoinsTimer.emplace(message);
+			NotEnoughCoinsTimer& timer = registry.notEnoughCoinsTimer.components[0];
+			timer.timer_ms = 5000.f;
+			// Add to coin count after clearing a room
+			registry.victories.emplace(player);
+			registry.remove_all_components_of(other_entity);
+			for (Entity entity: registry.enemies.entities ) {
+				registry.remove_all_components_of(entity);
+			}
+			soundSystem.playBossDeath();
+		}
+	}
 
-					Hotbar& hotbar = registry.hotbars.get(entity2);
-					for (int i = 0; i < hotbar.capacity; i++) {
-						if (hotbar.guns[i] == GUN_ID::NO_GUN) {
-							hotbar.guns[i] = registry.gunItems.get(entity1).id;
-							break;
-						}
-					}
-					soundSystem.playPowerUp();
-					registry.gunItems.remove(entity1);
-					registry.collisionMeshes.remove(entity1);
-					registry.items.get(entity1).item_id = ITEM_ID::NO_ITEM;
-				}
+	if (destroy_projectile) {
+		registry.remove_all_components_of(projectile_entity);
+	}
+}
 
-				if (registry.rangeItems.has(entity1) && !registry.itemContainers.has(entity1)) {
-					Animation& animation = registry.animations.get(entity1);
-					animation.frame = 0;
-					animation.row = 6;
-					animation.num_frames = 1;
+void WorldSystem::handle_projectile_wall(Entity projectile_entity, Entity, const Collision& collision) {
+	Projectile& projectile = registry.projectiles.get(projectile_entity);
 
-					Player& player = registry.players.get(entity2);
-					player.range += registry.rangeItems.get(entity1).increase;
+	// Ricochet projectiles off of walls
+	if (projectile.can_richochet) {
+		ricochet(projectile_entity, collision);
+		Entity particles = createParticleSystem(registry.motions.get(projectile_entity).position, collision.overlap_normal, 7, 150.0f, 0.f, 16, TEXTURE_ASSET_ID::SPARK_BASE);
+		ParticleSystem& particleSys = registry.particleSystems.get(particles);
+		particleSys.texture_glow = TEXTURE_ASSET_ID::SPARK_GLOW;
+		return;
+	}
 
-					if (player.range > player.max_range) {
-						player.range = player.max_range;
-					}
-					soundSystem.playPowerUp();
-					registry.rangeItems.remove(entity1);
-					registry.collisionMeshes.remove(entity1);
-					registry.items.get(entity1).item_id = ITEM_ID::NO_ITEM;
+	registry.remove_all_components_of(projectile_entity);
+}
+
+void WorldSystem::handle_projectile_item(Entity projectile_entity, Entity other_entity, const Collision&) {
+	if (registry.itemContainers.has(other_entity)) {
+		// Shatter glass container if have enough money
+		float cost = registry.itemContainers.get(other_entity).cost;
+		Player& player = registry.players.components[0];
+		if ((player.coins - cost) >= 0) {
+			soundSystem.playGlassBreak();
+			player.coins -= cost;
+			Animation& animation = registry.animations.get(other_entity);
+			animation.frame = 0;
+			if (registry.healthItems.has(other_entity)) {
+				animation.row = 8;
+			}
+			else if (registry.gunItems.has(other_entity)) {
+				if (registry.gunItems.get(other_entity).id == GUN_ID::BOUNCING_SHOT) {
+					animation.row = 24;
+				}
+				else if (registry.gunItems.get(other_entity).id == GUN_ID::SPLIT_SHOT) {
+					animation.row = 10;
 				}
-				// Handle player collisions here
-				//handle_player_collisions(entity2, entity1);
-				if (registry.dodgeTimers.has(entity2)) {
-					registry.dodgeTimers.remove(entity2);
+				else if (registry.gunItems.get(other_entity).id == GUN_ID::LONG_SHOT) {
+					animation.row = 28;
 				}
+				else if (registry.gunItems.get(other_entity).id == GUN_ID::RAPID_SHOT) {
+					animation.row = 30;
+				}
+			}
+			else if (registry.rangeItems.has(other_entity)) {
+				animation.row = 26;
 			}
+			registry.itemContainers.remove(other_entity);
+			registry.items.get(other_entity).shattered = true;
 		}
-		else { //player collides with open door
-			if ((registry.players.has(entity1) || registry.players.has(entity2)) && !registry.transitionTimers.has(entity1) ) {
-				printf("entered door\n");
-				{
-					if (!registry.dodgeTimers.has(entity1) && !registry.transitionTimers.has(entity1)) {
-						mesh1.is_solid = false;	
-						soundSystem.playSteps();
-						TransitionTimer& transitionTimer = registry.transitionTimers.emplace(entity1);
-						Door& door = registry.doors.get(entity2);
-						transitionTimer.from = door.direction;
-						transitionTimer.type = door.type;
-						printf("%d\n", transitionTimer.from);
-						registry.dodgeTimers.emplace(entity1);
-						registry.dodgeTimers.get(entity1).initialPosition = registry.motions.get(entity1).position;
-						switch (door.direction) {
-							case 0:
-								registry.dodgeTimers.get(entity1).finalPosition = { registry.motions.get(entity1).position.x
-							, registry.motions.get(entity1).position.y - 300};
-								break;
-							case 1:
-								registry.dodgeTimers.get(entity1).finalPosition = { registry.motions.get(entity1).position.x
-							+ 300, registry.motions.get(entity1).position.y };
-								break;
-							case 2:
-								registry.dodgeTimers.get(entity1).finalPosition = { registry.motions.get(entity1).position.x
-							, registry.motions.get(entity1).position.y + 300};
-								break;
-							case 3:
-								registry.dodgeTimers.get(entity1).finalPosition = { registry.motions.get(entity1).position.x
-							- 300, registry.motions.get(entity1).position.y };
-								break;
-						}
-					}
-				}
+		else {
+			// Produce "Not Enough Coins!" message if not enough money
+			if (registry.notEnoughCoinsTimer.components.size() >= 1)
+			{
+				NotEnoughCoinsTimer& timer = registry.notEnoughCoinsTimer.components[0];
+				timer.timer_ms = 1000.f;
+			}
+			else
+			{
+				Entity message = Entity(ENTITY_SCOPE::UI);
+				registry.notEnoughCoinsTimer.emplace(message);
+				registry.messages.insert(message,
+					{ 
+						"Not Enough Coins!",
+						vec2(window_width_px / 2, window_height_px / 2),
+						FONT_SIZE_ID::EXTRA_LARGE});
+				soundSystem.playError();
 			}
 		}
 	}
-	// Remove all collisions from this simulation step
-	registry.collisions.clear();
-	return;
+
+	registry.remove_all_components_of(projectile_entity);
+}
+
+void WorldSystem::handle_projectile_obstacle(Entity projectile_entity, Entity, const Collision&) {
+	registry.remove_all_components_of(projectile_entity);
+}
+
+void WorldSystem::handle_player_enemy(Entity player_entity, Entity other_entity, const Collision& collision) {
+	// Bombers explode on contact unless they are still being summoned
+	if (registry.enemies.get(other_entity).id == ENEMY_ID::BOMBER && !registry.summonTimers.has(other_entity)) {
+		explode(registry.motions.get(other_entity).position, registry.motions.get(other_entity).angle);
+		registry.remove_all_components_of(other_entity);
+		check_room_cleared();
+	}
+
+	handle_player_obstacle(player_entity, other_entity, collision);
+}
+
+void WorldSystem::handle_player_item(Entity player_entity, Entity other_entity, const Collision& collision) {
+	if (registry.healthItems.has(other_entity) && !registry.itemContainers.has(other_entity)) {
+		Animation& animation = registry.animations.get(other_entity);
+		animation.frame = 0;
+		animation.row = 6;
+		animation.num_frames = 1;
+
+		Player& player = registry.players.get(player_entity);
+		player.health += registry.healthItems.get(other_entity).restore;
+
+		if (player.health > player.max_health) {
+			player.health = player.max_health;
+		}
+		soundSystem.playHeal();
+		registry.healthItems.remove(other_entity);
+		registry.collisionMeshes.remove(other_entity);
+		registry.items.get(other_entity).item_id = ITEM_ID::NO_ITEM;
+	}
+
+	if (registry.gunItems.has(other_entity) && !registry.itemContainers.has(other_entity)) {
+		Animation& animation = registry.animations.get(other_entity);
+		animation.frame = 0;
+		animation.row = 6;
+		animation.num_frames = 1;
+
+		if (registry.gunItems.get(other_entity).id == GUN_ID::BOUNCING_SHOT) {
+			registry.hasBounces.emplace(player_entity);
+		}
+		else if (registry.gunItems.get(other_entity).id == GUN_ID::SPLIT_SHOT) {
+			registry.hasSplits.emplace(player_entity);
+		}
+		else if (registry.gunItems.get(other_entity).id == GUN_ID::LONG_SHOT) {
+			registry.hasLongs.emplace(player_entity);
+		}
+		else if (registry.gunItems.get(other_entity).id == GUN_ID::RAPID_SHOT) {
+			registry.hasRapids.emplace(player_entity);
+		}
+
+		Hotbar& hotbar = registry.hotbars.get(player_entity);
+		for (int i = 0; i < hotbar.capacity; i++) {
+			if (hotbar.guns[i] == GUN_ID::NO_GUN) {
+				hotbar.guns[i] = registry.gunItems.get(other_entity).id;
+				break;
+			}
+		}
+		soundSystem.playPowerUp();
+
+		registry.gunItems.remove(other_entity);
+		registry.collisionMeshes.remove(other_entity);
+		registry.items.get(other_entity).item_id = ITEM_ID::NO_ITEM;
+	}
+
+	if (registry.rangeItems.has(other_entity) && !registry.itemContainers.has(other_entity)) {
+		Animation& animation = registry.animations.get(other_entity);
+		animation.frame = 0;
+		animation.row = 6;
+		animation.num_frames = 1;
+
+		Player& player = registry.players.get(player_entity);
+		player.range += registry.rangeItems.get(other_entity).increase;
+
+		if (player.range > player.max_range) {
+			player.range = player.max_range;
+		}
+		soundSystem.playPowerUp();
+		registry.rangeItems.remove(other_entity);
+		registry.collisionMeshes.remove(other_entity);
+		registry.items.get(other_entity).item_id = ITEM_ID::NO_ITEM;
+	}
+
+	handle_player_obstacle(player_entity, other_entity, collision);
+}
+
+void WorldSystem::handle_player_obstacle(Entity player_entity, Entity, const Collision&) {
+	// Any solid contact ends a dodge
+	if (registry.dodgeTimers.has(player_entity)) {
+		registry.dodgeTimers.remove(player_entity);
+	}
+}
+
+//player collides with open door
+void WorldSystem::handle_player_door(Entity player_entity, Entity other_entity, const Collision&) {
+	if (registry.dodgeTimers.has(player_entity) || registry.transitionTimers.has(player_entity)) return;
+
+	printf("entered door\n");
+	Door& door = registry.doors.get(other_entity);
+	start_transition(player_entity, door.direction, door.type);
+}
+
+void WorldSystem::start_transition(Entity player_entity, int direction, int type) {
+	registry.collisionMeshes.get(player_entity).is_solid = false;
+	soundSystem.playSteps();
+	TransitionTimer& transitionTimer = registry.transitionTimers.emplace(player_entity);
+	transitionTimer.from = direction;
+	transitionTimer.type = type;
+	printf("%d\n", transitionTimer.from);
+
+	DodgeTimer& dodgeTimer = registry.dodgeTimers.emplace(player_entity);
+	vec2 position = registry.motions.get(player_entity).position;
+	dodgeTimer.initialPosition = position;
+	switch (direction) {
+		case 0:
+			dodgeTimer.finalPosition = { position.x, position.y - 300 };
+			break;
+		case 1:
+			dodgeTimer.finalPosition = { position.x + 300, position.y };
+			break;
+		case 2:
+			dodgeTimer.finalPosition = { position.x, position.y + 300 };
+			break;
+		case 3:
+			dodgeTimer.finalPosition = { position.x - 300, position.y };
+			break;
+	}
 }
 
 // Should the game be over ?
 bool WorldSystem::is_over() const {
+#ifdef HEADLESS
+	return false;
+#else
 	return bool(glfwWindowShouldClose(window));
+#endif
 }
 
 // On key callback
@@ -1733,8 +1462,6 @@ void WorldSystem::on_key(int key, int, int action, int mod) {
 
 	// Resetting game
 	if (action == GLFW_RELEASE && key == GLFW_KEY_R) {
-		int w, h;
-		glfwGetWindowSize(window, &w, &h);
         	restart_game();
 	}
 
@@ -1801,6 +1528,14 @@ void WorldSystem::on_key(int key, int, int action, int mod) {
 		}
 	}
 
+	// Profiler: F3 shows the breakdown of the last frame, F9 saves the recent frames as a Chrome trace
+	if (action == GLFW_PRESS && key == GLFW_KEY_F3) {
+		ui_system->profiler_visible = !ui_system->profiler_visible;
+	}
+	if (action == GLFW_PRESS && key == GLFW_KEY_F9) {
+		profiler.export_chrome_trace("profile_trace.json");
+	}
+
 	// Control the current speed with `<` `>`
 	if (action == GLFW_RELEASE && (mod & GLFW_MOD_SHIFT) && key == GLFW_KEY_COMMA) {
 		current_speed -= 0.1f;
@@ -1846,19 +1581,15 @@ void WorldSystem::on_scroll(double xoffset, double yoffset) {
 
 bool WorldSystem::load_game() {
 	current_speed = 1.f;
-	while (registry.motions.entities.size() > 0)
-		registry.remove_all_components_of(registry.motions.entities.back());
-	registry.dialogues.clear();
-	registry.alerts.clear();
-	registry.messages.clear();
-	registry.deathTimers.clear();
+	// Remove all entities that we created, the room and the UI a scope at a time and the old player on its own
+	registry.clear_scope(ENTITY_SCOPE::ROOM);
+	registry.clear_scope(ENTITY_SCOPE::UI);
+	registry.remove_all_components_of(player);
+	spawnQueue.clear();
 	// Debugging for memory/component leaks
 	registry.list_all_components();
 	registry.screenStates.components[0].screen_darken_factor = 0.0;
-	for (Entity particle : registry.particleSystems.entities) {
-		ParticleSystem& particleSystem = registry.particleSystems.get(particle);
-		registry.remove_all_components_of(particle);
-	}
+	bulletSystem.clear();
 	
 	printf("Loading game...\n");
 	player = createPlayer(renderer, { 200, 200 });
@@ -1867,6 +1598,7 @@ bool WorldSystem::load_game() {
 	Motion& motion_state = registry.motions.get(player);
 	tutorial_ongoing = false;
 	shop_room = true;
+	telemetry.set_room_type(ROOM_TYPE::SHOP);
 
 	std::string filePath = std::string(PROJECT_SOURCE_DIR) + "/data/save.json";
 	try {
@@ -1956,6 +1688,7 @@ bool WorldSystem::load_game() {
 
 		// Create Room and Start up
 		createLastRoom(renderer, player, last_door, doors, numItems, positions, item_ids, gun_ids, shatters);
+		room_planner.plan_doors(randomService.stream(RNG_STREAM::ROOMS), roomInputs(player));
 		ControllerSystem::set_player(player);
 		registry.colors.insert(player, { 1, 1, 1 });
 		soundSystem.playShopBGM();
@@ -5,7 +5,7 @@
 
 // stlib
 #include <vector>
-#include <random>
+#include <array>
 
 #define SDL_MAIN_HANDLED
 #include <SDL.h>
@@ -13,6 +13,15 @@
 
 #include "render_system.hpp"
 #include "sound_system.hpp"
+#include "room_planner.hpp"
+
+// A collision between two entities, ordered so that category <= other_category
+struct CollisionEvent {
+	int key;
+	Entity entity;
+	Entity other_entity;
+	Collision collision;
+};
 
 // Container for all our entities and game logic. Individual rendering / update is
 // deferred to the relative update() methods
@@ -43,6 +52,15 @@ public:
 	void start_game();
 
 	void check_ui();
+
+	// Moves the player into a new room of the given type, entered from the given direction
+	void enter_room(int from, int type);
+
+	// Walks the player through the door in the given direction, the room of the given type is built during the transition
+	void start_transition(Entity player_entity, int direction, int type);
+
+	// Replaces the current room with a stress test scenario, see scenario.hpp for the format
+	bool load_scenario(const std::string& path);
 	
 private:
 	// Input callback functions
@@ -50,13 +68,31 @@ private:
 
 	void on_scroll(double x, double y);
 
-	// restart level
-	void enter_room(int from, int type);
 	void addRandomMovement(Boid& boid);
 	void on_mouse_button(int button, int action, int mod);
 
 	void explode(vec2 position, float angle);
 
+	// Collision handling
+	// Each handler receives the entity with the lower COLLISION_CATEGORY first
+	typedef void (WorldSystem::*CollisionHandler)(Entity entity, Entity other_entity, const Collision& collision);
+	std::array<CollisionHandler, 2 * collision_category_count * collision_category_count> collision_handlers;
+	std::vector<CollisionEvent> collision_events;
+	void init_collision_handlers();
+	void register_collision_handler(bool is_solid, COLLISION_CATEGORY category, COLLISION_CATEGORY other_category, CollisionHandler handler);
+	void handle_projectile_player(Entity projectile_entity, Entity other_entity, const Collision& collision);
+	// Applies the damage of a projectile to the player and handles its death
+	void damage_player(Entity player_entity, float damage);
+	void handle_projectile_enemy(Entity projectile_entity, Entity other_entity, const Collision& collision);
+	void handle_projectile_boss(Entity projectile_entity, Entity other_entity, const Collision& collision);
+	void handle_projectile_wall(Entity projectile_entity, Entity other_entity, const Collision& collision);
+	void handle_projectile_item(Entity projectile_entity, Entity other_entity, const Collision& collision);
+	void handle_projectile_obstacle(Entity projectile_entity, Entity other_entity, const Collision& collision);
+	void handle_player_enemy(Entity player_entity, Entity other_entity, const Collision& collision);
+	void handle_player_item(Entity player_entity, Entity other_entity, const Collision& collision);
+	void handle_player_obstacle(Entity player_entity, Entity other_entity, const Collision& collision);
+	void handle_player_door(Entity player_entity, Entity other_entity, const Collision& collision);
+
 	// OpenGL window handle
 	GLFWwindow* window;
 
@@ -67,13 +103,9 @@ private:
 	float next_turtle_spawn;
 	float next_fish_spawn;
 	Entity player;
+	// The rooms behind the doors of the current room
+	RoomPlanner room_planner;
 
 	// Reset the world state to its initial state
 	void restart_game();
-
-
-
-	// C++ random number generator
-	std::default_random_engine rng;
-	std::uniform_real_distribution<float> uniform_dist; // number between 0..1
 };
@@ -0,0 +1,90 @@
+// Compares two state hash files written by treasuregunner_headless --hash
+// Reports the first frame where the runs diverge and the component types whose hashes differ
+// Usage: treasuregunner_hashdiff EXPECTED ACTUAL
+// Exits with 0 if the runs match, 1 if they diverge and 2 if a file can't be read
+
+// stlib
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+// internal
+#include "state_hash.hpp"
+
+struct HashLine {
+	long long frame;
+	StateHash state;
+};
+
+static bool read_hashes(const char* path, std::vector<HashLine>& lines)
+{
+	FILE* file = fopen(path, "r");
+	if (file == NULL) {
+		printf("Can't open %s\n", path);
+		return false;
+	}
+	char buffer[512];
+	int line_number = 0;
+	while (fgets(buffer, sizeof(buffer), file)) {
+		line_number++;
+		if (buffer[0] == '#' || buffer[0] == '\n')
+			continue;
+		HashLine line;
+		char* cursor = buffer;
+		line.frame = strtoll(cursor, &cursor, 10);
+		for (int i = 0; i < hashed_component_count; i++) {
+			char* end;
+			line.state.components[i] = strtoull(cursor, &end, 16);
+			if (end == cursor) {
+				printf("%s:%d: expected %d hashes\n", path, line_number, hashed_component_count);
+				fclose(file);
+				return false;
+			}
+			cursor = end;
+		}
+		lines.push_back(line);
+	}
+	fclose(file);
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc != 3) {
+		printf("Usage: %s EXPECTED ACTUAL\n", argv[0]);
+		return 2;
+	}
+	std::vector<HashLine> expected, actual;
+	if (!read_hashes(argv[1], expected) || !read_hashes(argv[2], actual))
+		return 2;
+
+	size_t common = std::min(expected.size(), actual.size());
+	for (size_t i = 0; i < common; i++) {
+		const HashLine& a = expected[i];
+		const HashLine& b = actual[i];
+		if (a.frame != b.frame) {
+			printf("Line %zu: frame %lld in %s but frame %lld in %s\n", i + 1, a.frame, argv[1], b.frame, argv[2]);
+			return 1;
+		}
+		bool diverged = false;
+		for (int c = 0; c < hashed_component_count; c++) {
+			if (a.state.components[c] == b.state.components[c])
+				continue;
+			if (!diverged)
+				printf("Runs diverge at frame %lld\n", a.frame);
+			diverged = true;
+			printf("  %-12s %016" PRIx64 " != %016" PRIx64 "\n", hashed_component_names[c], a.state.components[c], b.state.components[c]);
+		}
+		if (diverged)
+			return 1;
+	}
+	if (expected.size() != actual.size()) {
+		printf("Runs match for %zu frames, then %s has %zu frames and %s has %zu\n", common, argv[1], expected.size(), argv[2], actual.size());
+		return 1;
+	}
+	printf("Runs match for all %zu frames\n", common);
+	return 0;
+}